@@ -2,6 +2,7 @@
 #include <DHT.h>
 
 #include <Aggregator.hpp>
+#include <StreamLineWorker.hpp>
 
 #define DHT_PIN 19
 
@@ -51,57 +52,23 @@ class MyDHTSensor : private DHT, public Worker<DHTData> {
   }
 };
 
-struct SerialCommand {
-  enum Type {
-    e_invalid = '.',
-    e_threshold = 't',
-    e_serial_output = 's'
-  };
-
-  Type type;
-  int val;
+enum CommandTypes {
+  e_threshold,
+  e_serial_output
 };
 
 /**
- * Some sensor that counts upwards every second
+ * Read serial to set threshold.
+ *    Send new threshold with t<number> (like `t22` to set 22)
+ *    Send serial output enable with s<0|1> (like `s0` to disable output)
  */
-class SerialCommandReader : public Worker<SerialCommand> {
- public:
-
-  SerialCommandReader() : Worker<SerialCommand>({SerialCommand::e_invalid, 0}, 0) {}
-
- protected:
-  /**
-   * Read serial to set threshold.
-   *    Send new threshold with t<number> (like `t22` to set 22)
-   *    Send serial output enable with s<0|1> (like `s0` to disable output)
-   */
-  int8_t produce_data() override {
-    if(Serial.available() > 0) {
-      char command = Serial.read();
-      if(Serial.available() <= 0) return Worker::e_worker_idle;
-      auto string = Serial.readString();
-      switch(command){
-        case SerialCommand::e_threshold:
-          data.type = SerialCommand::e_threshold;
-          data.val = string.toInt();
-          break;
-        case SerialCommand::e_serial_output:
-          data.type = SerialCommand::e_serial_output;
-          data.val = string.toInt() != 0;
-          break;
-        default:
-          return Worker::e_worker_idle;
-      }
-      if(data.val == 0 && string.indexOf('0') < 0) {
-        return Worker::e_worker_error;
-      }
-      return Worker::e_worker_data_read;
-    }
-    return Worker::e_worker_idle;
-  }
+const CommandSpec serial_commands[] = {
+    {"t", e_threshold, CommandSpec::e_arg_int},
+    {"s", e_serial_output, CommandSpec::e_arg_bool},
 };
 
+typedef StreamCommandWorker<32> SerialCommandReader;
+
 /**
  * A data handler that outputs the measurement through serial
  */
@@ -139,14 +106,12 @@ class SerialSupervisor : public Supervisor {
     if(serial_reader->is_fresh()) {
       auto& command = serial_reader->get_data();
       switch(command.type){
-        case SerialCommand::e_threshold:
-          Serial.printf("threshold now: %d\n", command.val);
-          break;
-        case SerialCommand::e_serial_output:
-          aggregator.set_handler_active(e_my_serial_handler, command.val);
-          Serial.printf("output now: %s\n", command.val ? "enabled" : "disabled");
+        case e_threshold:
+          Serial.printf("threshold now: %d\n", command.int_value);
           break;
-        case SerialCommand::e_invalid:
+        case e_serial_output:
+          aggregator.set_handler_active(e_my_serial_handler, command.int_value);
+          Serial.printf("output now: %s\n", command.int_value ? "enabled" : "disabled");
           break;
       }
     }
@@ -158,7 +123,7 @@ class SerialSupervisor : public Supervisor {
 };
 
 MyDHTSensor sensor;
-SerialCommandReader serial_reader;
+SerialCommandReader serial_reader(Serial, serial_commands, sizeof(serial_commands) / sizeof(serial_commands[0]));
 SerialReporter handler_s;
 SerialSupervisor supervisor;
 
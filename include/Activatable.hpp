@@ -5,6 +5,12 @@
 #ifndef SENSOR_HANDLER_INCLUDE_ACTIVATABLE_HPP_
 #define SENSOR_HANDLER_INCLUDE_ACTIVATABLE_HPP_
 
+#include "CircuitBreaker.hpp"
+
+class Aggregator;
+class BaseWorker;
+class Handler;
+
 /**
  * Some abstract class used by the receiver and observer
  */
@@ -16,6 +22,17 @@ class Activatable {
     e_state_activating_failed,
   } State;
 
+  /**
+   * Priority class, used by the aggregator when a tick budget is set (see Aggregator::set_tick_budget)
+   * High priority work always runs, lower priority work is deferred or shed when the budget is exhausted
+   */
+  typedef enum Priority {
+    e_priority_high = 0,
+    e_priority_normal,
+    e_priority_low,
+    e_priority_count,
+  } Priority;
+
   Activatable();
 
   /**
@@ -37,6 +54,33 @@ class Activatable {
    */
   virtual bool set_active(bool _activate) final;
 
+  /**
+   * Set the priority class of the worker/handler (default normal)
+   * @param priority
+   */
+  void set_priority(Priority priority);
+
+  /**
+   * Get the priority class of the worker/handler
+   * @return
+   */
+  Priority get_priority() const;
+
+  /**
+   * Stop calling the worker/handler for a while when too many of its last calls failed (status above 0), see
+   * CircuitBreaker. Disabled by default
+   * @param threshold : failures in the window that open the circuit (0 to disable)
+   * @param window : amount of last calls to look at (at most 32)
+   * @param open_millis : time the worker/handler is not called before a probe call
+   */
+  void set_circuit_breaker(uint8_t threshold, uint8_t window = 16, uint32_t open_millis = 10000);
+
+  /**
+   * Get the circuit breaker (to see its state)
+   * @return
+   */
+  const CircuitBreaker& get_circuit_breaker() const;
+
  protected:
 
   /**
@@ -59,7 +103,24 @@ class Activatable {
   virtual void deactivate();
 
  private:
+  /**
+   * Checks the circuit breaker before calling the worker/handler
+   */
+  bool breaker_allows();
+
+  /**
+   * Record the status of a call in the circuit breaker
+   */
+  void record_outcome(int8_t status);
+
   State active_state;
+  Priority priority;
+  bool deferred;
+  CircuitBreaker circuit_breaker;
+
+  friend Aggregator;
+  friend BaseWorker;
+  friend Handler;
 };
 
 #endif //SENSOR_HANDLER_INCLUDE_ACTIVATABLE_HPP_
@@ -9,6 +9,7 @@
 #include <map>
 #include "Handler.hpp"
 #include "Supervisor.hpp"
+#include "TickSnapshot.hpp"
 #include "Worker.hpp"
 
 /**
@@ -20,8 +21,48 @@
  */
 class Aggregator {
  public:
+  /**
+   * Statistics of the tick budget, counters per priority class
+   */
+  struct TickStats {
+    uint32_t ticks;
+    uint32_t overrun_ticks; // Ticks that took longer than the budget
+    uint32_t last_tick_micros;
+    uint32_t max_tick_micros;
+    uint32_t deferrals[Activatable::e_priority_count]; // Worker runs deferred to the next tick
+    uint32_t shed[Activatable::e_priority_count]; // Handler runs skipped, the fresh data of that tick is not handled
+    uint32_t overruns[Activatable::e_priority_count]; // Runs that exceeded the remaining budget
+  };
+
+  /**
+   * Kind of component, used to refer to workers and handlers during boot
+   */
+  typedef enum ComponentKind {
+    e_component_worker,
+    e_component_handler,
+  } ComponentKind;
+
+  /**
+   * State of a worker/handler during boot
+   */
+  typedef enum BootState {
+    e_boot_pending,
+    e_boot_running,
+    e_boot_done, // Initialized and activated
+    e_boot_failed, // Activation failed, a dependency failed, timed out or can't be booted (unknown or a cycle)
+    e_boot_timeout, // Did not finish in time, the task is left to finish (and updates the state when it does)
+  } BootState;
+
+  /**
+   * Statistics of the pipelined mode
+   */
+  struct PipelineStats {
+    uint32_t snapshots; // Snapshots handed to the handler stage
+    uint32_t stalls; // Times the worker stage had to wait for a free snapshot (backpressure)
+  };
+
   Aggregator();
-  virtual ~Aggregator() = default;
+  virtual ~Aggregator();
 
   /**
    * Add a new worker to the aggregator
@@ -42,14 +83,62 @@ class Aggregator {
   void register_supervisor(Supervisor& supervisor);
 
   /**
-   * Set the active status of a worker
+   * Don't initialize workers/handlers when they are registered, but in `boot` (concurrently). Call before registering
+   * @param deferred
+   */
+  void set_deferred_initialization(bool deferred);
+
+  /**
+   * Let a worker/handler wait in `boot` until another one is up
+   * @param kind, id : the dependent worker/handler
+   * @param dependency_kind, dependency_id : the worker/handler it depends on
+   */
+  void add_boot_dependency(ComponentKind kind, uint8_t id, ComponentKind dependency_kind, uint8_t dependency_id);
+
+  /**
+   * Set the time a worker/handler may take to initialize and activate in `boot` (overrides the boot timeout)
+   * @param kind, id : the worker/handler
+   * @param timeout_millis
+   */
+  void set_boot_timeout(ComponentKind kind, uint8_t id, uint32_t timeout_millis);
+
+  /**
+   * Initialize (when deferred) and activate all inactive workers and handlers concurrently, each in its own task
+   * spread over both cores, respecting the boot dependencies. Returns when everything is up or has failed.
+   * A worker/handler that takes longer than its timeout is reported as timed out, its task is left to finish; boot
+   * can't be called again until it did, and the destructor waits for it. Dependencies on unknown workers/handlers or in a cycle fail.
+   * The worker/handler maps are only locked while collecting what to boot: initialize() and activate() may register
+   * workers/handlers or change their state, those registered during boot are not booted by it.
+   * @param timeout_millis : default time per worker/handler
+   * @param priority : priority of the boot tasks
+   * @param memory : stack size of the boot tasks
+   * @return true if all workers/handlers are active, false if not or when tasks of the previous boot still run
+   */
+  bool boot(uint32_t timeout_millis=10000, uint8_t priority=5, uint32_t memory=4096);
+
+  /**
+   * Get the state of a worker/handler after boot
+   * @param kind, id : the worker/handler
+   * @return
+   */
+  BootState get_boot_state(ComponentKind kind, uint8_t id) const;
+
+  /**
+   * Time the last boot took
+   * @return duration in millis
+   */
+  uint32_t get_boot_duration() const;
+
+  /**
+   * Set the active status of a worker. Safe to call from other tasks, waits for the worker stage to finish
    * @param worker_id
    * @param active
    */
   void set_worker_active(uint8_t worker_id, bool active);
 
   /**
-   * Add a new data handler to the aggregator
+   * Set the active status of a handler. Safe to call from other tasks, waits for the handler stage to finish (in
+   * pipelined mode only for the snapshot handler being called)
    * @param worker_id
    * @param active
    */
@@ -65,11 +154,193 @@ class Aggregator {
    */
   void run();
 
+  /**
+   * Limit the time spent per run. High priority workers/handlers always run. When the budget is exhausted, lower
+   * priority workers that are due are deferred to the next run (they produce a run later), and lower priority handlers
+   * shed the load of this run: they are not called for its fresh data (counted in TickStats::shed). A deferred worker
+   * or shedding handler always runs the next time, so nothing starves. Process workers are never deferred in a run in
+   * which any worker was fresh: they react to fresh sources, which are no longer fresh a run later. Only
+   * workers/handlers that would run (due, processing or with fresh data) are charged. Supervisors always run.
+   * @param budget_micros : time budget per run in microseconds, 0 for unlimited (default)
+   */
+  void set_tick_budget(uint32_t budget_micros);
+
+  /**
+   * Get the tick budget statistics
+   * @return
+   */
+  const TickStats& get_tick_stats() const;
+
+  /**
+   * Reset the tick budget statistics
+   */
+  void reset_tick_stats();
+
+  /**
+   * Enable pipelined mode: the fresh worker data of each run is copied into a snapshot which is handled on a separate
+   * task (ideally on the other core), while the next run already starts producing. Register all workers and handlers
+   * before enabling. Only handlers implementing `handle_produced_snapshot` (and `handles_snapshots`) move to the separate
+   * task, other handlers and the supervisors keep running in run(). Snapshots only hold data that can be copied as raw
+   * bytes (see TickSnapshot).
+   * When `depth` snapshots are in flight, run() waits for the handler stage (backpressure).
+   * @param depth : amount of snapshots in flight (at least 1). Use 1 when snapshots hold spans into the arenas of
+   * ArenaWorkers, at a larger depth those may be reused while an older snapshot is handled
+   * @param core : core to run the handler stage on
+   * @param priority : priority of the handler stage task
+   * @param memory : stack size of the handler stage task
+   * @param poll_millis : how often processing (async) handlers are checked when no snapshots arrive
+   * @return true if started
+   */
+  bool enable_pipelining(uint8_t depth=2, uint8_t core=0, uint8_t priority=5, uint32_t memory=4096, uint32_t poll_millis=10);
+
+  /**
+   * Stop pipelined mode, waits until the in flight snapshots are handled
+   */
+  void disable_pipelining();
+
+  /**
+   * Get the statistics of the pipelined mode
+   * @return
+   */
+  const PipelineStats& get_pipeline_stats() const;
+
+  /**
+   * Run the aggregator in its own task instead of calling run() from the Arduino loop
+   * @param period_millis : time between the start of each run, 0 to run freely (yields 1 tick between runs)
+   * @param priority : priority of the task
+   * @param core : core to run the task on
+   * @param memory : stack size of the task
+   * @return true if started
+   */
+  bool start(uint32_t period_millis=0, uint8_t priority=1, uint8_t core=1, uint32_t memory=8192);
+
+  /**
+   * Stop the aggregator task, waits until the current run is finished. Called from the aggregator task itself (by a
+   * worker/handler/supervisor) it returns right away and the task stops after that run; running() is false from then
+   * on. The finished task is collected by the next stop() or start(), or the destructor
+   */
+  void stop();
+
+  /**
+   * Checks if the aggregator task is running
+   * @return
+   */
+  bool running() const;
+
+  /**
+   * Round the slots of workers with an aligned schedule (see BaseWorker::set_aligned_schedule) up to a global grid,
+   * so workers with unrelated periods still produce in the same run when their slots are close
+   * @param grid_millis : grid size, 1 to disable (default)
+   */
+  void set_sampling_grid(uint32_t grid_millis);
+
+  /**
+   * Time until the first active worker is due, can be used to sleep between runs
+   * @return time in millis, 0 if a worker is due (or busy async)
+   */
+  uint32_t get_millis_until_due() const;
+
+  /**
+   * Get the cache of encoded worker data shared by the handlers (see WorkerMap::encode)
+   * @return
+   */
+  EncodingCache& get_encoding_cache();
+
  private:
+  /**
+   * Let the workers produce, then the process workers
+   * @return true if any new data was produced
+   */
+  bool run_workers();
+
+  /**
+   * Let the handlers handle the produced work (in pipelined mode only the handlers without snapshot support)
+   * @param any_new : true if any worker produced new data
+   */
+  void run_handlers(bool any_new);
+
+  /**
+   * Check if a worker/handler that wants to run can run within the tick budget, marks it deferred if not
+   * @param counters : counters per priority to count it in when it can't run
+   * @return true if it should run
+   */
+  bool within_budget(Activatable& component, uint32_t* counters);
+
+  /**
+   * Count an overrun if the worker/handler that started at `started` exhausted the budget
+   */
+  void account_budget(const Activatable& component, uint32_t started);
+
+  /**
+   * Capture the workers into a free snapshot and pass it to the handler stage
+   */
+  void hand_off_snapshot();
+
+  static void run_pipeline(void* instance);
+
+  struct BootItem {
+    Activatable* component;
+    uint16_t key; // kind << 8 | id
+    bool initialize;
+    volatile BootState state; // Written by the boot task once it runs
+    volatile bool timed_out; // Written by boot
+    uint32_t timeout;
+    uint32_t started;
+    Aggregator* aggregator;
+  };
+
+  struct BootOptions {
+    uint32_t timeout; // 0 for the default
+    std::vector<uint16_t> dependencies;
+  };
+
+  static uint16_t boot_key(ComponentKind kind, uint8_t id);
+  bool boot_dependencies_done(const BootItem& item, bool& failed);
+
+  /**
+   * Checks if a worker/handler that is not booting is registered and active
+   */
+  bool component_active(uint16_t key);
+  static void run_boot_task(void* instance);
+
+  static void run_task(void* instance);
+
   WorkerMap workers;
   HandlerMap handlers;
+  EncodingCache encoding_cache;
   std::vector<Supervisor*> supervisors;
 
+  uint32_t sampling_grid;
+  uint32_t tick_budget;
+  uint32_t tick_start;
+  TickStats tick_stats;
+
+  std::vector<TickSnapshot> snapshots;
+  QueueHandle_t pipeline_free;
+  QueueHandle_t pipeline_filled;
+  SemaphoreHandle_t pipeline_done;
+  TaskHandle_t pipeline_task;
+  uint32_t pipeline_poll;
+  uint32_t pipeline_sequence;
+  PipelineStats pipeline_stats;
+
+  // Guard the worker / handler stages against activation changes from other tasks
+  SemaphoreHandle_t workers_mutex;
+  SemaphoreHandle_t handlers_mutex;
+
+  bool deferred_initialization;
+  std::vector<Activatable*> uninitialized;
+  std::map<uint16_t, BootOptions> boot_options;
+  std::vector<BootItem> boot_items;
+  SemaphoreHandle_t boot_signal;
+  volatile uint32_t boot_tasks; // Boot tasks that still run, they use the items and the signal until they end
+  uint32_t boot_duration;
+
+  TaskHandle_t aggregator_task;
+  SemaphoreHandle_t aggregator_done;
+  uint32_t run_period;
+  volatile bool stop_requested;
+
 };
 
 #endif //SENSOR_REPORTER_AGGREGATOR_HPP_
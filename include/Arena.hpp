@@ -0,0 +1,313 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_ARENA_HPP_
+#define SENSOR_REPORTER_ARENA_HPP_
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <type_traits>
+#include "Worker.hpp"
+
+/*
+ * Allocators for variable size payloads without the general heap: a bump arena that is reset as a whole (like every
+ * produce) and a pool of fixed size blocks for buffers that live longer. Both work on static storage and return
+ * nullptr (or an empty span) when exhausted, they never fall back to the heap.
+ * Neither is thread safe, use them from one task (or guard them yourself).
+ */
+
+/**
+ * View on a range of elements owned by someone else (like an arena)
+ * @tparam T: element type
+ */
+template<typename T>
+struct Span {
+  T* data;
+  size_t length;
+
+  Span() : data(nullptr), length(0) {
+  }
+
+  Span(T* data, size_t length) : data(data), length(length) {
+  }
+
+  T* begin() const {
+    return data;
+  }
+
+  T* end() const {
+    return data + length;
+  }
+
+  size_t size() const {
+    return length;
+  }
+
+  bool empty() const {
+    return length == 0;
+  }
+
+  T& operator[](size_t index) const {
+    return data[index];
+  }
+};
+
+/**
+ * Bump allocator over a buffer: allocations are a pointer increment, everything is freed at once by reset().
+ * Only for types that need no destructor.
+ */
+class Arena {
+ public:
+  /**
+   * @param buffer : storage, must outlive the arena
+   * @param capacity : size of the storage
+   */
+  Arena(uint8_t* buffer, size_t capacity);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * Allocate uninitialized memory
+   * @param size : bytes to allocate
+   * @param alignment : power of 2
+   * @return pointer to the memory, nullptr when the arena is exhausted
+   */
+  void* allocate(size_t size, size_t alignment = alignof(max_align_t));
+
+  /**
+   * Allocate a zero initialized array
+   * @tparam T: element type
+   * @param count : amount of elements
+   * @return span over the elements, empty when the arena is exhausted
+   */
+  template<typename T>
+  Span<T> allocate_span(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value, "arena memory is freed without calling destructors");
+    T* elements = (T*) allocate(sizeof(T) * count, alignof(T));
+    if (!elements) {
+      return Span<T>();
+    }
+    memset((void*) elements, 0, sizeof(T) * count);
+    return Span<T>(elements, count);
+  }
+
+  /**
+   * Copy a string into the arena
+   * @param text : null terminated string
+   * @return span over the copy (null terminated, length without the terminator), empty when the arena is exhausted
+   */
+  Span<char> copy(const char* text);
+
+  /**
+   * Copy bytes into the arena
+   * @param bytes
+   * @param length
+   * @return span over the copy, empty when the arena is exhausted
+   */
+  Span<uint8_t> copy(const uint8_t* bytes, size_t length);
+
+  /**
+   * Format a string into the arena, uses exactly the space needed
+   * @param format : printf format
+   * @return span over the string (null terminated, length without the terminator), empty when it does not fit
+   */
+  Span<char> printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  /**
+   * Free all allocations
+   */
+  void reset();
+
+  /**
+   * Bytes in use
+   * @return
+   */
+  size_t used() const;
+
+  /**
+   * Bytes that can still be allocated (without alignment padding)
+   * @return
+   */
+  size_t remaining() const;
+
+  /**
+   * Size of the storage
+   * @return
+   */
+  size_t capacity() const;
+
+  /**
+   * Most bytes ever in use at once, to size the storage
+   * @return
+   */
+  size_t get_high_water() const;
+
+  /**
+   * Allocations that failed because the arena was exhausted
+   * @return
+   */
+  uint32_t get_failed_allocations() const;
+
+ private:
+  uint8_t* buffer;
+  size_t size;
+  size_t offset;
+  size_t high_water;
+  uint32_t failed_allocations;
+};
+
+/**
+ * Arena with its own storage
+ * @tparam N: size of the storage in bytes
+ */
+template<size_t N>
+class BumpArena : public Arena {
+ public:
+  BumpArena() : Arena(storage, N) {
+  }
+
+ private:
+  alignas(max_align_t) uint8_t storage[N];
+};
+
+/**
+ * Pool of fixed size blocks, acquire and release in O(1) in any order
+ */
+class BlockPool {
+ public:
+  /**
+   * @param buffer : storage of block_count * block_size bytes, aligned for the data stored in the blocks
+   * @param block_size : size of a block, at least the size of a pointer and a multiple of the alignment
+   * @param block_count : amount of blocks
+   */
+  BlockPool(uint8_t* buffer, size_t block_size, size_t block_count);
+
+  BlockPool(const BlockPool&) = delete;
+  BlockPool& operator=(const BlockPool&) = delete;
+
+  /**
+   * Take a block from the pool
+   * @return pointer to an uninitialized block, nullptr when all blocks are in use
+   */
+  void* acquire();
+
+  /**
+   * Return a block to the pool
+   * @param block : block from acquire() of this pool (nullptr is ignored)
+   */
+  void release(void* block);
+
+  /**
+   * Checks if the pointer points into the storage of this pool
+   * @param block
+   * @return
+   */
+  bool owns(const void* block) const;
+
+  /**
+   * Amount of blocks that can be acquired
+   * @return
+   */
+  size_t available() const;
+
+  /**
+   * Size of a block
+   * @return
+   */
+  size_t get_block_size() const;
+
+  /**
+   * Acquires that failed because all blocks were in use
+   * @return
+   */
+  uint32_t get_failed_acquires() const;
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  uint8_t* buffer;
+  size_t block_size;
+  size_t block_count;
+  FreeBlock* free_list;
+  size_t free_blocks;
+  uint32_t failed_acquires;
+};
+
+/**
+ * Block pool with its own storage
+ * @tparam BlockSize: size of a block in bytes (rounded up to the alignment)
+ * @tparam Count: amount of blocks
+ */
+template<size_t BlockSize, size_t Count>
+class FixedBlockPool : public BlockPool {
+ public:
+  static const size_t aligned_block_size =
+      (BlockSize + alignof(max_align_t) - 1) / alignof(max_align_t) * alignof(max_align_t);
+
+  FixedBlockPool() : BlockPool(storage, aligned_block_size, Count) {
+  }
+
+ private:
+  alignas(max_align_t) uint8_t storage[aligned_block_size * Count];
+};
+
+/**
+ * Worker for data with variable size parts (text, sample blocks), stored as spans into an arena owned by the worker.
+ * The worker has two arenas: one holds the current data, the other is reset and handed to produce_arena_data. When
+ * fresh data is produced, the arenas swap. So spans in replaced data stay valid until the worker produces again.
+ * A pipelined handler (see Aggregator::enable_pipelining) can use the spans of a snapshot only at pipeline depth 1: the
+ * worker stage then waits for the snapshot to be handled before it produces again. At a larger depth the arena may be
+ * reset while an older snapshot is handled.
+ * @tparam T: data type (holding spans)
+ * @tparam N: size of each arena in bytes
+ */
+template<typename T, size_t N>
+class ArenaWorker : public Worker<T> {
+ public:
+  /**
+   * @param initial : initial data (should not hold spans)
+   * @param break_duration : time between produces
+   */
+  ArenaWorker(T initial, uint32_t break_duration = 0) : Worker<T>(initial, break_duration), front(0) {
+  }
+
+  /**
+   * Get the arena holding the current data, for its statistics
+   * @return
+   */
+  const Arena& get_arena() const {
+    return arenas[front];
+  }
+
+ protected:
+  /**
+   * Produce data, allocate its variable size parts from the arena
+   * @param next : data to fill, starts value initialized (empty spans). Spans of the current data point into the arena
+   * that is reset on the next produce, copy only plain fields over (from get_data())
+   * @param arena : empty arena, an allocation failing means the arena is too small for this reading
+   * @return status like produce_data, only e_worker_data_read publishes `next`
+   */
+  virtual int8_t produce_arena_data(T& next, Arena& arena) = 0;
+
+  int8_t produce_data() final {
+    Arena& back = arenas[front ^ 1];
+    back.reset();
+    T next = T();
+    int8_t result = produce_arena_data(next, back);
+    if (result == BaseWorker::e_worker_data_read) {
+      this->data = next;
+      front ^= 1;
+    }
+    return result;
+  }
+
+ private:
+  BumpArena<N> arenas[2];
+  uint8_t front;
+};
+
+#endif //SENSOR_REPORTER_ARENA_HPP_
@@ -0,0 +1,132 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_BUS_HPP_
+#define SENSOR_REPORTER_BUS_HPP_
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <map>
+#include <vector>
+
+/**
+ * Register access to devices on a shared bus (I2C, SPI). Accesses between begin_transaction and end_transaction share
+ * the bus setup, see BusArbiter to batch the reads of several workers in one transaction.
+ */
+class Bus {
+ public:
+  virtual ~Bus() = default;
+
+  /**
+   * Set up the bus for a batch of accesses (like clock settings or taking the bus)
+   * @return true if the bus can be used
+   */
+  virtual bool begin_transaction() = 0;
+
+  /**
+   * Release the bus after a batch of accesses
+   */
+  virtual void end_transaction() = 0;
+
+  /**
+   * Read bytes starting at a register of a device
+   * @param address : device address
+   * @param reg : register to start reading at
+   * @param buffer : receives the bytes
+   * @param length : amount of bytes to read
+   * @return true if all bytes were read
+   */
+  virtual bool read_register(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) = 0;
+
+  /**
+   * Write bytes starting at a register of a device
+   * @param address : device address
+   * @param reg : register to start writing at
+   * @param buffer : bytes to write
+   * @param length : amount of bytes to write
+   * @return true if all bytes were written
+   */
+  virtual bool write_register(uint8_t address, uint8_t reg, const uint8_t* buffer, uint8_t length) = 0;
+};
+
+/**
+ * I2C bus over an Arduino TwoWire (like Wire). On I2C every register access is a transmission of its own (start,
+ * address, stop), so a transaction does not save bus time per read: a burst saves the locking and scheduling per
+ * worker, and sets the bus clock once per burst when a clock is given.
+ */
+class WireBus : public Bus {
+ public:
+  /**
+   * @param wire : started TwoWire instance, must outlive the bus
+   * @param clock_hz : bus clock set at the start of every transaction (when other users of the bus change it), 0 to
+   * leave the clock alone
+   */
+  explicit WireBus(TwoWire& wire, uint32_t clock_hz = 0);
+
+  bool begin_transaction() override;
+  void end_transaction() override;
+  bool read_register(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) override;
+  bool write_register(uint8_t address, uint8_t reg, const uint8_t* buffer, uint8_t length) override;
+
+ private:
+  TwoWire& wire;
+  uint32_t clock_hz;
+};
+
+/**
+ * Bus with simulated devices to test bus users without hardware. Counts the cost of the accesses: every transaction
+ * costs a fixed setup time, every byte (including address and register) a transfer time. Accesses outside a
+ * transaction are a transaction of their own.
+ */
+class SimulatedBus : public Bus {
+ public:
+  struct Stats {
+    uint32_t transactions;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t failures; // Accesses to a device or register that does not exist
+    uint32_t bytes; // Bytes on the bus, including address and register
+    uint32_t busy_micros; // Simulated time the bus was in use
+  };
+
+  /**
+   * @param transaction_micros : setup cost of a transaction
+   * @param byte_micros : cost of a byte (about 90 for I2C at 100 kHz)
+   */
+  explicit SimulatedBus(uint32_t transaction_micros = 50, uint32_t byte_micros = 90);
+
+  /**
+   * Set the contents of a register, reading it returns these bytes (zero padded)
+   * @param address : device address
+   * @param reg
+   * @param buffer
+   * @param length
+   */
+  void set_register(uint8_t address, uint8_t reg, const uint8_t* buffer, uint8_t length);
+
+  /**
+   * Remove all registers of a device, accesses to it fail
+   * @param address
+   */
+  void remove_device(uint8_t address);
+
+  bool begin_transaction() override;
+  void end_transaction() override;
+  bool read_register(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) override;
+  bool write_register(uint8_t address, uint8_t reg, const uint8_t* buffer, uint8_t length) override;
+
+  const Stats& get_stats() const;
+  void reset_stats();
+
+ private:
+  void access(uint8_t length);
+
+  std::map<uint16_t, std::vector<uint8_t>> registers;
+  uint32_t transaction_micros;
+  uint32_t byte_micros;
+  bool in_transaction;
+  Stats stats;
+};
+
+#endif //SENSOR_REPORTER_BUS_HPP_
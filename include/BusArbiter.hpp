@@ -0,0 +1,176 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_BUSARBITER_HPP_
+#define SENSOR_REPORTER_BUSARBITER_HPP_
+
+#include <Arduino.h>
+#include <vector>
+#include "Bus.hpp"
+#include "Worker.hpp"
+
+/**
+ * Owns a shared bus: serializes access from the aggregator and async tasks, and reads the registers of several
+ * workers in one transaction (burst) instead of one transaction per worker. Register the arbiter as a normal worker,
+ * the workers reading through it (see BusReadWorker) are process workers so they see the burst of the same run. A read
+ * stays available until its worker took it, so a worker deferred by the tick budget decodes it on its next run.
+ *
+ * Reads are due on their own period (fixed rate). Reads due within the coalesce window are pulled into the burst of
+ * a read that is due now. The data of the arbiter is the number of the last burst.
+ */
+class BusArbiter : public Worker<uint32_t> {
+ public:
+  static const uint8_t no_job = 0xFF;
+
+  struct Stats {
+    uint32_t bursts;
+    uint32_t reads;
+    uint32_t failed_reads;
+    uint32_t coalesced; // Reads done early to share a burst
+    uint32_t contended; // Runs the burst was postponed because an async task held the bus
+  };
+
+  /**
+   * @param bus : bus to arbitrate, must outlive the arbiter
+   */
+  explicit BusArbiter(Bus& bus);
+  ~BusArbiter() override;
+
+  /**
+   * Add a register read that is done periodically in a burst
+   * @param address : device address
+   * @param reg : register to start reading at
+   * @param buffer : receives the bytes, must outlive the arbiter. Written by the aggregator task
+   * @param length : amount of bytes to read
+   * @param period : time between reads in millis
+   * @return job id, no_job if there are too many
+   */
+  uint8_t add_read(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length, uint32_t period);
+
+  /**
+   * Pull reads that are due within this time into a burst that runs now (default 0)
+   * @param millis
+   */
+  void set_coalesce_window(uint32_t millis);
+
+  /**
+   * Checks if a read was done in the burst of this run (successful or not)
+   * @param job
+   * @return
+   */
+  bool job_completed(uint8_t job) const;
+
+  /**
+   * Take a read that was done since the last take (successful or not), the buffer holds its bytes
+   * @param job
+   * @return true if there was a read to take
+   */
+  bool take_job(uint8_t job);
+
+  /**
+   * Checks if the last read of a job failed
+   * @param job
+   * @return
+   */
+  bool job_failed(uint8_t job) const;
+
+  /**
+   * Take the bus for direct access, like from an async task. Reentrant
+   * @param timeout_millis
+   * @return true if taken, release it with unlock
+   */
+  bool lock(uint32_t timeout_millis = portMAX_DELAY);
+  void unlock();
+
+  /**
+   * Read a register in a transaction of its own, locks the bus
+   * @return true if all bytes were read
+   */
+  bool read_register(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length);
+
+  /**
+   * Write a register in a transaction of its own, locks the bus
+   * @return true if all bytes were written
+   */
+  bool write_register(uint8_t address, uint8_t reg, const uint8_t* buffer, uint8_t length);
+
+  /**
+   * Get the bus, only use it while holding the lock
+   * @return
+   */
+  Bus& get_bus();
+
+  const Stats& get_stats() const;
+
+ protected:
+  int8_t produce_data() override;
+
+ private:
+  struct Job {
+    uint8_t address;
+    uint8_t reg;
+    uint8_t* buffer;
+    uint8_t length;
+    bool started;
+    bool failed;
+    bool unread; // Read in a burst, not taken yet
+    uint32_t period;
+    uint32_t next_due;
+    uint32_t burst; // Burst the job was last read in
+  };
+
+  Bus& bus;
+  SemaphoreHandle_t mutex;
+  std::vector<Job> jobs;
+  uint32_t coalesce_window;
+  Stats stats;
+};
+
+/**
+ * Worker reading device registers through a BusArbiter. Implement decode to turn the raw bytes into data.
+ * Produces e_worker_error on every run when the arbiter has no room for its read.
+ * @tparam T : type of the data it produces
+ * @tparam N : amount of bytes to read
+ */
+template<typename T, uint8_t N>
+class BusReadWorker : public ProcessWorker<T> {
+ public:
+  /**
+   * @param arbiter : arbiter of the bus the device is on
+   * @param address : device address
+   * @param reg : register to start reading at
+   * @param period : time between reads in millis
+   */
+  BusReadWorker(BusArbiter& arbiter, uint8_t address, uint8_t reg, uint32_t period)
+      : ProcessWorker<T>(), arbiter(arbiter), raw(), job(arbiter.add_read(address, reg, raw, N, period)) {
+  }
+
+  virtual ~BusReadWorker() = default;
+
+ protected:
+  /**
+   * Turn the bytes read into data
+   * @param bytes : N bytes read from the device
+   * @return status code (BaseWorker::Status or any custom)
+   */
+  virtual int8_t decode(const uint8_t* bytes) = 0;
+
+  BusArbiter& arbiter;
+
+ private:
+  int8_t produce_data(const WorkerMap& workers) final {
+    if (job == BusArbiter::no_job) {
+      return BaseWorker::e_worker_error;
+    }
+    if (!arbiter.take_job(job)) {
+      return BaseWorker::e_worker_idle;
+    }
+    return arbiter.job_failed(job) ? (int8_t) BaseWorker::e_worker_error : decode(raw);
+  }
+
+  uint8_t raw[N];
+  uint8_t job;
+};
+
+#endif //SENSOR_REPORTER_BUSARBITER_HPP_
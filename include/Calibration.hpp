@@ -0,0 +1,251 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_CALIBRATION_HPP_
+#define SENSOR_REPORTER_CALIBRATION_HPP_
+
+#include <Arduino.h>
+#include "FixedPoint.hpp"
+#include "Worker.hpp"
+
+/**
+ * Compile time math to define calibration curves with (std::log and std::exp are not constexpr). Accurate to about
+ * 1e-12 relative, only meant to generate tables.
+ */
+namespace calibration_math {
+
+constexpr double ln_2 = 0.6931471805599453;
+
+constexpr double atanh_series(double term, double y2, int k, int terms) {
+  return terms == 0 ? 0 : term / (2 * k + 1) + atanh_series(term * y2, y2, k + 1, terms - 1);
+}
+
+// ln(x) = 2 * atanh((x - 1) / (x + 1)), converges fast for x in [0.5, 2]
+constexpr double log_reduced(double y) {
+  return 2 * atanh_series(y, y * y, 0, 30);
+}
+
+constexpr double log_scaled(double x, int exponent) {
+  return x > 2 ? log_scaled(x / 2, exponent + 1)
+               : x < 0.5 ? log_scaled(x * 2, exponent - 1)
+                         : log_reduced((x - 1) / (x + 1)) + exponent * ln_2;
+}
+
+/**
+ * Natural logarithm, -1e300 for x <= 0
+ */
+constexpr double log(double x) {
+  return x <= 0 ? -1e300 : log_scaled(x, 0);
+}
+
+constexpr double exp_series(double x, double term, int k, int terms) {
+  return terms == 0 ? 0 : term + exp_series(x, term * x / (k + 1), k + 1, terms - 1);
+}
+
+/**
+ * e^x
+ */
+constexpr double exp(double x) {
+  return x > 0.5 || x < -0.5 ? exp(x / 2) * exp(x / 2) : exp_series(x, 1, 0, 20);
+}
+
+/**
+ * x^y for x > 0
+ */
+constexpr double pow(double x, double y) {
+  return exp(y * log(x));
+}
+
+}
+
+/**
+ * Compile time list of indices 0..N-1 (std::index_sequence is C++14), built in log(N) steps to stay under the
+ * template depth limit for large tables
+ */
+namespace calibration_detail {
+
+template<size_t... I>
+struct index_sequence {
+};
+
+template<typename A, typename B>
+struct concat;
+
+template<size_t... A, size_t... B>
+struct concat<index_sequence<A...>, index_sequence<B...>> {
+  typedef index_sequence<A..., (sizeof...(A) + B)...> type;
+};
+
+template<size_t N>
+struct make_index_sequence {
+  typedef typename concat<typename make_index_sequence<N / 2>::type,
+                          typename make_index_sequence<N - N / 2>::type>::type type;
+};
+
+template<>
+struct make_index_sequence<0> {
+  typedef index_sequence<> type;
+};
+
+template<>
+struct make_index_sequence<1> {
+  typedef index_sequence<0> type;
+};
+
+constexpr fixed_t clamp_to_fixed(double value) {
+  return value >= 32767.0 ? to_fixed(32767.0f)
+                          : value <= -32767.0 ? to_fixed(-32767.0f)
+                                              : (fixed_t) (value * FIXED_ONE + (value < 0 ? -0.5 : 0.5));
+}
+
+template<typename Curve, uint16_t N>
+constexpr fixed_t sample(size_t index) {
+  return clamp_to_fixed(
+      Curve::evaluate(Curve::min_input + (double) (Curve::max_input - Curve::min_input) * index / (N - 1)));
+}
+
+template<typename Curve, uint16_t N, typename Indices>
+struct TableData;
+
+template<typename Curve, uint16_t N, size_t... I>
+struct TableData<Curve, N, index_sequence<I...>> {
+  static constexpr fixed_t values[N] = {sample<Curve, N>(I)...};
+};
+
+template<typename Curve, uint16_t N, size_t... I>
+constexpr fixed_t TableData<Curve, N, index_sequence<I...>>::values[N];
+
+}
+
+/**
+ * Curve sampled at compile time into a table of N points (const, so in flash), evaluated with fixed point linear
+ * interpolation: a multiply and a few adds instead of float math with log / pow on every sample.
+ *
+ * A curve is a type with the input range and a constexpr function (see Thermistor):
+ *   struct Curve {
+ *     static constexpr int32_t min_input = 0;
+ *     static constexpr int32_t max_input = 4095;
+ *     static constexpr double evaluate(double input) { return ...; }
+ *   };
+ * The error is the error of linear interpolation between the points, take more points where the curve bends strongly.
+ * A 10k NTC (Thermistor<10000, 10000, 3950>) over -40..120 C is within 0.96 C of the formula with 64 points, 0.053 C
+ * with 256 and 0.014 C with 512 (tests/CalibrationTest.cpp).
+ * Outputs are clamped to the fixed point range.
+ * @tparam Curve
+ * @tparam N : amount of points, at least 2
+ */
+template<typename Curve, uint16_t N = 64>
+class LookupTable {
+  static_assert(N >= 2, "A lookup table needs at least 2 points");
+  static_assert(Curve::max_input > Curve::min_input, "The input range of the curve is empty");
+
+  typedef calibration_detail::TableData<Curve, N, typename calibration_detail::make_index_sequence<N>::type> Data;
+
+  // Q16 table position per input step
+  static constexpr uint64_t step = ((uint64_t) (N - 1) << 32) / (uint32_t) (Curve::max_input - Curve::min_input);
+
+ public:
+  /**
+   * Calibrated value of an input, inputs outside the range of the curve are clamped
+   * @param input : raw value
+   * @return calibrated value
+   */
+  static fixed_t evaluate(int32_t input) {
+    if (input <= Curve::min_input) {
+      return Data::values[0];
+    }
+    if (input >= Curve::max_input) {
+      return Data::values[N - 1];
+    }
+    uint64_t position = ((uint64_t) (uint32_t) (input - Curve::min_input) * step) >> 16;
+    auto index = (uint32_t) (position >> 16);
+    auto fraction = (int64_t) (position & 0xFFFF);
+    fixed_t low = Data::values[index];
+    return low + (fixed_t) (((Data::values[index + 1] - low) * fraction) >> 16);
+  }
+
+  /**
+   * Get a point of the table
+   * @param index : 0..N-1
+   * @return
+   */
+  static constexpr fixed_t point(uint16_t index) {
+    return Data::values[index];
+  }
+};
+
+/**
+ * NTC thermistor in a voltage divider: series resistor to the supply, thermistor to ground, ADC on the junction.
+ * Converts the ADC reading to degrees Celsius with the beta equation.
+ * @tparam SeriesOhm : series resistor
+ * @tparam NominalOhm : resistance of the thermistor at the nominal temperature
+ * @tparam Beta : beta coefficient of the thermistor
+ * @tparam AdcMax : reading at the supply voltage (4095 for 12 bits)
+ * @tparam NominalCelsius : nominal temperature (usually 25)
+ */
+template<uint32_t SeriesOhm, uint32_t NominalOhm, uint16_t Beta, int32_t AdcMax = 4095, int8_t NominalCelsius = 25>
+struct Thermistor {
+  // The ends of the range are an open or shorted thermistor
+  static constexpr int32_t min_input = 1;
+  static constexpr int32_t max_input = AdcMax - 1;
+
+  static constexpr double resistance(double reading) {
+    return (double) SeriesOhm * reading / (AdcMax - reading);
+  }
+
+  static constexpr double evaluate(double reading) {
+    return 1.0 / (1.0 / (NominalCelsius + 273.15) + calibration_math::log(resistance(reading) / NominalOhm) / Beta)
+        - 273.15;
+  }
+};
+
+/**
+ * Process worker that calibrates a raw field of the data of another worker with a LookupTable, whenever that worker
+ * is fresh. Produces the calibrated value in fixed point
+ * @tparam T: data type of the source worker
+ * @tparam Curve: the calibration curve, see LookupTable
+ * @tparam N: amount of points in the table
+ */
+template<typename T, typename Curve, uint16_t N = 64>
+class CalibrationWorker : public ProcessWorker<fixed_t> {
+ public:
+  /**
+   * Reads the raw field to calibrate from the source data
+   */
+  typedef int32_t (*Accessor)(const T& data);
+
+  typedef LookupTable<Curve, N> Table;
+
+  /**
+   * @param source_id : id of the worker with the raw values
+   * @param accessor : function to get the raw field
+   */
+  CalibrationWorker(uint8_t source_id, Accessor accessor)
+      : ProcessWorker<fixed_t>(0, 0), source_id(source_id), accessor(accessor) {
+  }
+
+  /**
+   * Get the calibrated value as float
+   * @return
+   */
+  float get_value() const {
+    return from_fixed(data);
+  }
+
+ protected:
+  int8_t produce_data(const WorkerMap& workers) override {
+    auto source = workers.worker<Worker<T>>(source_id);
+    if (source && source->is_fresh()) {
+      data = Table::evaluate(accessor(source->get_data()));
+      return e_worker_data_read;
+    }
+    return e_worker_idle;
+  }
+
+ private:
+  uint8_t source_id;
+  Accessor accessor;
+};
+
+#endif //SENSOR_REPORTER_CALIBRATION_HPP_
@@ -0,0 +1,91 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_CIRCUITBREAKER_HPP_
+#define SENSOR_REPORTER_CIRCUITBREAKER_HPP_
+
+#include <Arduino.h>
+
+/**
+ * Tracks the outcomes of the last calls of a component (up to 32) and stops calling it when too many failed.
+ * Closed: every call is allowed. Open: no calls until the open duration passed. Half open: one probe call is allowed,
+ * other calls are rejected until its outcome is recorded: success closes the circuit, failure opens it again.
+ */
+class CircuitBreaker {
+ public:
+  typedef enum State {
+    e_breaker_closed,
+    e_breaker_open,
+    e_breaker_half_open,
+  } State;
+
+  CircuitBreaker();
+
+  /**
+   * Enable the breaker
+   * @param threshold : failures in the window that open the circuit (0 disables the breaker)
+   * @param window : amount of last outcomes to look at (at most 32)
+   * @param open_millis : time the circuit stays open before a probe call
+   */
+  void configure(uint8_t threshold, uint8_t window, uint32_t open_millis);
+
+  /**
+   * Checks if the component may be called now
+   * @param now : time in millis
+   * @return
+   */
+  bool allow(uint32_t now);
+
+  /**
+   * Record the outcome of a call
+   * @param success
+   * @param now : time in millis
+   */
+  void record(bool success, uint32_t now);
+
+  /**
+   * The allowed call ended without an outcome (like idle), a half open circuit allows the next call as probe
+   */
+  void cancel_probe();
+
+  /**
+   * Close the circuit and forget the outcomes
+   */
+  void reset();
+
+  State get_state() const;
+
+  /**
+   * Failures in the window
+   * @return
+   */
+  uint8_t get_failures() const;
+
+  /**
+   * Times the circuit opened
+   * @return
+   */
+  uint32_t get_trips() const;
+
+  /**
+   * Calls that were not made because the circuit was open
+   * @return
+   */
+  uint32_t get_rejected() const;
+
+ private:
+  void open(uint32_t now);
+
+  State state;
+  uint8_t threshold;
+  uint8_t window;
+  uint32_t open_millis;
+  uint32_t outcomes; // Bit per outcome, most recent in bit 0, 1 for failure
+  uint32_t opened_at;
+  uint32_t trips;
+  uint32_t rejected;
+  bool probe_in_flight;
+};
+
+#endif //SENSOR_REPORTER_CIRCUITBREAKER_HPP_
@@ -0,0 +1,93 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_CLOCK_HPP_
+#define SENSOR_REPORTER_CLOCK_HPP_
+
+#include <Arduino.h>
+
+/**
+ * Time source used by the framework instead of calling millis() directly. Defaults to the system time, can be
+ * replaced (for example by a VirtualClock) to run the framework deterministically, like when replaying recordings.
+ */
+class Clock {
+ public:
+  Clock() = default;
+  virtual ~Clock() = default;
+
+  /**
+   * Current time in milliseconds
+   * @return
+   */
+  virtual uint32_t millis() const;
+
+  /**
+   * Current time in microseconds
+   * @return
+   */
+  virtual uint32_t micros() const;
+
+  /**
+   * Get the clock used by the framework
+   * @return
+   */
+  static Clock& get();
+
+  /**
+   * Replace the clock used by the framework. The clock must outlive its use
+   * @param clock
+   */
+  static void set(Clock& clock);
+
+  /**
+   * Restore the system clock
+   */
+  static void reset();
+
+ private:
+  static Clock system_clock;
+  static Clock* current;
+};
+
+/**
+ * Clock that is controlled manually (advance / set_time) or runs at a multiple of the system time
+ */
+class VirtualClock : public Clock {
+ public:
+  /**
+   * Construct a manually controlled clock
+   * @param start_millis : initial time
+   */
+  explicit VirtualClock(uint32_t start_millis = 0);
+
+  uint32_t millis() const override;
+  uint32_t micros() const override;
+
+  /**
+   * Set the current time, stops accelerated mode
+   * @param time_millis
+   */
+  void set_time(uint32_t time_millis);
+
+  /**
+   * Move the clock forward
+   * @param duration_millis
+   */
+  void advance(uint32_t duration_millis);
+
+  /**
+   * Let the clock run at speed times the system time from the current time, 0 to control it manually again
+   * @param speed
+   */
+  void set_speed(uint32_t speed);
+
+ private:
+  uint64_t elapsed_micros() const;
+
+  uint64_t time_micros;
+  uint32_t speed;
+  uint32_t anchor_micros;
+};
+
+#endif //SENSOR_REPORTER_CLOCK_HPP_
@@ -0,0 +1,79 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_COMMANDPARSER_HPP_
+#define SENSOR_REPORTER_COMMANDPARSER_HPP_
+
+#include <Arduino.h>
+#include "Worker.hpp"
+
+/**
+ * Describes a command: its name and the type of its (optional) argument
+ */
+struct CommandSpec {
+  typedef enum Argument {
+    e_arg_none,
+    e_arg_int,
+    e_arg_float,
+    e_arg_bool, // 0/1, on/off, true/false
+    e_arg_word, // Rest of the line
+  } Argument;
+
+  const char* name;
+  uint8_t type; // Custom command type, copied into the parsed command
+  Argument argument;
+};
+
+/**
+ * A parsed command. The word argument points into the parsed line
+ */
+struct Command {
+  typedef enum Status {
+    e_command_ok = 0,
+    e_command_unknown,
+    e_command_bad_argument,
+  } Status;
+
+  Status status;
+  uint8_t type;
+  int32_t int_value;
+  float float_value;
+  const char* word;
+  size_t word_length;
+};
+
+/**
+ * The word points into the parsed line, a copy is not valid after the next line (not recorded or snapshotted)
+ */
+template<>
+struct is_raw_copyable<Command> : std::false_type {
+};
+
+/**
+ * Parses lines into commands using a table of command specs, without heap allocations.
+ * The command name is matched against the start of the line (longest name wins) and may be followed directly or after
+ * spaces by the argument, so both `t22` and `t 22` parse as command `t` with argument 22.
+ */
+class CommandParser {
+ public:
+  /**
+   * @param table : command specs, must outlive the parser
+   * @param size : amount of specs
+   */
+  CommandParser(const CommandSpec* table, size_t size);
+
+  /**
+   * Parse a null terminated line
+   * @param line
+   * @param command : parsed command, status tells if it is valid
+   * @return true if the command is valid
+   */
+  bool parse(const char* line, Command& command) const;
+
+ private:
+  const CommandSpec* table;
+  size_t size;
+};
+
+#endif //SENSOR_REPORTER_COMMANDPARSER_HPP_
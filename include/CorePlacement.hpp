@@ -0,0 +1,83 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_COREPLACEMENT_HPP_
+#define SENSOR_REPORTER_COREPLACEMENT_HPP_
+
+#include <Arduino.h>
+
+#ifdef portNUM_PROCESSORS
+#define SENSOR_REPORTER_CORES portNUM_PROCESSORS
+#else
+#define SENSOR_REPORTER_CORES 2
+#endif
+
+/**
+ * Chooses the core for async tasks (start_task with core_auto): the core with the fewest tasks in flight, ties broken
+ * by the busy time of the tasks that ran there recently (a sum of task durations that halves every half life).
+ * Explicitly pinned tasks are counted as well. Only the framework's own tasks are accounted, use set_core_bias to
+ * account for other load (like the Wi-Fi stack on core 0).
+ */
+class CorePlacement {
+ public:
+  // Core argument of start_task to let the framework choose
+  static const uint8_t core_auto = 0xFF;
+
+  struct Stats {
+    uint32_t placements[SENSOR_REPORTER_CORES]; // Tasks started per core
+    uint32_t automatic; // Tasks that were placed automatically
+    uint8_t in_flight[SENSOR_REPORTER_CORES]; // Tasks running per core
+    uint32_t busy_micros[SENSOR_REPORTER_CORES]; // Decayed busy time per core
+    uint8_t last_core; // Core of the last task started
+  };
+
+  /**
+   * Choose the core for a task that is about to start, and count it
+   * @param requested : core to pin to, or core_auto
+   * @return core to start the task on
+   */
+  static uint8_t place(uint8_t requested);
+
+  /**
+   * Count a task as finished
+   * @param core : core returned by place
+   * @param busy_micros : time the task ran
+   */
+  static void finish(uint8_t core, uint32_t busy_micros);
+
+  /**
+   * Add a fixed amount of busy time to a core when comparing, to steer automatic placement away from it
+   * @param core
+   * @param busy_micros
+   */
+  static void set_core_bias(uint8_t core, uint32_t busy_micros);
+
+  /**
+   * Set how fast the busy time decays (default 1000 millis)
+   * @param half_life_millis
+   */
+  static void set_half_life(uint32_t half_life_millis);
+
+  /**
+   * Get a copy of the placement statistics
+   * @return
+   */
+  static Stats get_stats();
+
+  /**
+   * Reset the statistics (tasks in flight are kept)
+   */
+  static void reset_stats();
+
+ private:
+  static void decay(uint32_t now);
+
+  static Stats stats;
+  static uint32_t bias[SENSOR_REPORTER_CORES];
+  static uint32_t half_life;
+  static uint32_t last_decay;
+  static portMUX_TYPE lock;
+};
+
+#endif //SENSOR_REPORTER_COREPLACEMENT_HPP_
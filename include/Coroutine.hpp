@@ -0,0 +1,143 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_COROUTINE_HPP_
+#define SENSOR_REPORTER_COROUTINE_HPP_
+
+#include <Arduino.h>
+#include "Clock.hpp"
+#include "Handler.hpp"
+#include "Worker.hpp"
+
+/**
+ * State of a stackless coroutine (protothread style): where to resume and a wake up time, 8 bytes.
+ * A coroutine is a function written between SR_CO_BEGIN and SR_CO_END that suspends with SR_CO_YIELD, SR_CO_AWAIT or
+ * SR_CO_SLEEP by returning `Coroutine::suspended`, and continues after that point when called again.
+ * Limitations: local variables are not kept while suspended (use members), no `switch` around a suspend point and at
+ * most one suspend point per line.
+ */
+struct Coroutine {
+  // Returned while suspended, the same value as e_worker_processing and e_handler_processing
+  static const int8_t suspended = -2;
+
+  uint32_t line; // Line to resume at, 0 when not started
+  uint32_t wake_time;
+
+  Coroutine() : line(0), wake_time(0) {
+  }
+
+  /**
+   * Checks if the coroutine is suspended
+   * @return
+   */
+  bool running() const {
+    return line != 0;
+  }
+
+  /**
+   * Start over on the next call
+   */
+  void reset() {
+    line = 0;
+  }
+};
+
+#define SR_CO_BEGIN(co) switch ((co).line) { case 0:
+
+#define SR_CO_END(co) } (co).line = 0
+
+/**
+ * Suspend until the next run
+ */
+#define SR_CO_YIELD(co) do { (co).line = __LINE__; return Coroutine::suspended; case __LINE__:; } while (0)
+
+/**
+ * Suspend until the condition is true (checked once every run)
+ */
+#define SR_CO_AWAIT(co, condition) \
+  do { (co).line = __LINE__; if (false) { case __LINE__:; } if (!(condition)) return Coroutine::suspended; } while (0)
+
+/**
+ * Suspend for at least the duration in millis (on the framework clock)
+ */
+#define SR_CO_SLEEP(co, duration) \
+  do { \
+    (co).wake_time = Clock::get().millis() + (duration); \
+    SR_CO_AWAIT(co, (int32_t) (Clock::get().millis() - (co).wake_time) >= 0); \
+  } while (0)
+
+/**
+ * Worker that produces its data as a coroutine, resumed by the aggregator on its own task every run until it
+ * finishes. An alternative to start_task for work that mostly waits (on timers, a bus, a response): no task and no
+ * stack per worker, no context switches. The worker is processing (not fresh) while suspended.
+ * Write `data` only after the last suspend point, handlers can read it while the worker is suspended.
+ * @tparam T: Type of the data it produces
+ */
+template<typename T>
+class CoWorker : public Worker<T> {
+ public:
+  explicit CoWorker(uint32_t break_duration = 0) : Worker<T>(break_duration), co() {
+  }
+
+  explicit CoWorker(T initial_val, uint32_t break_duration = 0) : Worker<T>(initial_val, break_duration), co() {
+  }
+
+ protected:
+  /**
+   * The coroutine producing the data: SR_CO_BEGIN(co); ... SR_CO_END(co); return status;
+   * @return Coroutine::suspended when suspended, otherwise the status code (BaseWorker::Status or any custom)
+   */
+  virtual int8_t produce_coroutine() = 0;
+
+  int8_t produce_data() final {
+    co.reset();
+    return step();
+  }
+
+  int8_t resume_async() final {
+    return step();
+  }
+
+  Coroutine co;
+
+ private:
+  int8_t step() {
+    int8_t result = produce_coroutine();
+    if (result != Coroutine::suspended) {
+      co.reset();
+    }
+    return result;
+  }
+};
+
+/**
+ * Handler that handles the data as a coroutine, resumed by the aggregator on its own task every run until it finishes
+ * (see CoWorker). Copy what is needed from the workers before the first suspend point, when resumed the workers are
+ * those of a later run. Not used for snapshots in pipelined mode.
+ */
+class CoHandler : public Handler {
+ public:
+  CoHandler();
+
+ protected:
+  /**
+   * The coroutine handling the data: SR_CO_BEGIN(co); ... SR_CO_END(co); return status;
+   * @param workers : all the data from the workers
+   * @return Coroutine::suspended when suspended, otherwise the status code (Handler::Status or any custom)
+   */
+  virtual int8_t handle_coroutine(const WorkerMap& workers) = 0;
+
+  int8_t handle_produced_work(const WorkerMap& workers) final;
+
+  int8_t resume_async() final;
+
+  Coroutine co;
+
+ private:
+  int8_t step();
+
+  const WorkerMap* workers;
+};
+
+#endif //SENSOR_REPORTER_COROUTINE_HPP_
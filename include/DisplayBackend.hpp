@@ -0,0 +1,73 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_DISPLAYBACKEND_HPP_
+#define SENSOR_REPORTER_DISPLAYBACKEND_HPP_
+
+#include <Arduino.h>
+#include <vector>
+
+/**
+ * Text based screen used by the DisplaySupervisor. Implement this for an actual display (LCD / OLED with a fixed
+ * font), drawing is done in batches so bus writes can be combined.
+ */
+class DisplayBackend {
+ public:
+  virtual ~DisplayBackend() = default;
+
+  /**
+   * Start a batch of draws
+   */
+  virtual void begin_batch() {}
+
+  /**
+   * Draw text at a cell position
+   * @param column
+   * @param row
+   * @param text : not null terminated
+   * @param length
+   */
+  virtual void draw_text(uint16_t column, uint16_t row, const char* text, size_t length) = 0;
+
+  /**
+   * End a batch of draws, push the changes to the screen
+   */
+  virtual void end_batch() {}
+};
+
+/**
+ * Display kept in memory, to test and benchmark display supervisors on the host
+ */
+class MemoryDisplay : public DisplayBackend {
+ public:
+  MemoryDisplay(uint16_t columns, uint16_t rows);
+
+  void begin_batch() override;
+  void draw_text(uint16_t column, uint16_t row, const char* text, size_t length) override;
+  void end_batch() override;
+
+  /**
+   * Get a row of the screen (null terminated)
+   * @param row
+   * @return
+   */
+  const char* get_row(uint16_t row) const;
+
+  /**
+   * Amount of draw calls and characters drawn, and batches
+   */
+  uint32_t get_draw_calls() const;
+  uint32_t get_chars_drawn() const;
+  uint32_t get_batches() const;
+
+ private:
+  uint16_t columns;
+  uint16_t rows;
+  std::vector<char> cells;
+  uint32_t draw_calls;
+  uint32_t chars_drawn;
+  uint32_t batches;
+};
+
+#endif //SENSOR_REPORTER_DISPLAYBACKEND_HPP_
@@ -0,0 +1,88 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_DISPLAYSUPERVISOR_HPP_
+#define SENSOR_REPORTER_DISPLAYSUPERVISOR_HPP_
+
+#include <Arduino.h>
+#include <vector>
+#include "DisplayBackend.hpp"
+#include "Supervisor.hpp"
+
+/**
+ * Supervisor that shows fields on a text display and only redraws what changed.
+ * Fields are bound to a worker (formatted when it is fresh), a handler (formatted when its status changes) or to
+ * nothing (formatted every report). The rendered text is compared to a shadow buffer and only the changed part of each
+ * field is drawn, all changes of a report in one batch.
+ */
+class DisplaySupervisor : public Supervisor {
+ public:
+  /**
+   * Formats a field
+   * @param workers
+   * @param handlers
+   * @param out : buffer to write the text into
+   * @param capacity : size of the buffer (field width + 1)
+   * @return length of the text (longer text is cut off, shorter is padded with spaces)
+   */
+  typedef size_t (*Formatter)(const WorkerMap& workers, const HandlerMap& handlers, char* out, size_t capacity);
+
+  explicit DisplaySupervisor(DisplayBackend& display);
+
+  /**
+   * Add a field that is formatted whenever the worker is fresh
+   * @return index of the field
+   */
+  size_t add_worker_field(uint16_t column, uint16_t row, uint16_t width, uint8_t worker_id, Formatter formatter);
+
+  /**
+   * Add a field that is formatted whenever the status of the handler changes
+   * @return index of the field
+   */
+  size_t add_handler_field(uint16_t column, uint16_t row, uint16_t width, uint8_t handler_id, Formatter formatter);
+
+  /**
+   * Add a field that is formatted on every report
+   * @return index of the field
+   */
+  size_t add_field(uint16_t column, uint16_t row, uint16_t width, Formatter formatter);
+
+  /**
+   * Force a full redraw on the next report (like after the display was cleared)
+   */
+  void invalidate();
+
+  void initialize() override;
+
+  void handle_report(const WorkerMap& workers, const HandlerMap& handlers) override;
+
+ private:
+  typedef enum Source {
+    e_source_always,
+    e_source_worker,
+    e_source_handler,
+  } Source;
+
+  struct Field {
+    uint16_t column;
+    uint16_t row;
+    uint16_t width;
+    Source source;
+    uint8_t source_id;
+    int8_t last_status;
+    Formatter formatter;
+    size_t shadow_offset;
+  };
+
+  size_t add(uint16_t column, uint16_t row, uint16_t width, Source source, uint8_t source_id, Formatter formatter);
+  bool needs_format(Field& field, const WorkerMap& workers, const HandlerMap& handlers);
+
+  DisplayBackend& display;
+  std::vector<Field> fields;
+  std::vector<char> shadow;
+  std::vector<char> scratch;
+  bool full_redraw;
+};
+
+#endif //SENSOR_REPORTER_DISPLAYSUPERVISOR_HPP_
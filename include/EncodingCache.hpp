@@ -0,0 +1,78 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_ENCODINGCACHE_HPP_
+#define SENSOR_REPORTER_ENCODINGCACHE_HPP_
+
+#include <Arduino.h>
+#include <vector>
+
+class BaseWorker;
+
+/**
+ * Per run cache of encoded worker data, so multiple handlers outputting the same data (serial log, http, radio) only
+ * encode it once. Entries are keyed by (worker id, format) and are dropped when the worker produces again and at the
+ * start of every run. Use through WorkerMap::encode.
+ */
+class EncodingCache {
+ public:
+  /**
+   * Encodes the data of a worker into the buffer. Like snprintf: the encoding fits when its length is below the
+   * capacity (the last byte is kept for a terminator), a length of capacity or more means it was cut off
+   * @return length of the encoded data (excluding a terminator), 0 on failure, capacity or more when it does not fit
+   */
+  typedef size_t (*Encoder)(const BaseWorker& worker, uint8_t* buffer, size_t capacity);
+
+  struct Stats {
+    uint32_t hits;
+    uint32_t encodes;
+    uint32_t overflows; // Encodings that did not fit in the cache
+  };
+
+  /**
+   * @param capacity : bytes available for encoded data per run
+   * @param max_entries : amount of encodings per run
+   */
+  explicit EncodingCache(size_t capacity = 512, uint8_t max_entries = 8);
+
+  /**
+   * Get the encoded data of a worker, encodes it on the first request of this run
+   * @param worker
+   * @param format : custom format id, the same format must always use the same encoder
+   * @param encoder : encodes the data when not cached
+   * @param length : receives the length of the encoded data
+   * @return pointer to the encoded data (valid until the next run), nullptr if encoding failed or did not fit (in
+   * which case the caller should encode into its own buffer)
+   */
+  const uint8_t* encode(const BaseWorker& worker, uint8_t format, Encoder encoder, size_t& length);
+
+  /**
+   * Drop all entries (called by the aggregator at the start of every run)
+   */
+  void clear();
+
+  /**
+   * Get the cache statistics
+   * @return
+   */
+  const Stats& get_stats() const;
+
+ private:
+  struct Entry {
+    uint8_t worker_id;
+    uint8_t format;
+    uint32_t produce_count;
+    size_t offset;
+    size_t length;
+  };
+
+  std::vector<uint8_t> buffer;
+  std::vector<Entry> entries;
+  size_t capacity;
+  uint8_t max_entries;
+  size_t used;
+  Stats stats;
+};
+
+#endif //SENSOR_REPORTER_ENCODINGCACHE_HPP_
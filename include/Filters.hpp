@@ -0,0 +1,393 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_FILTERS_HPP_
+#define SENSOR_REPORTER_FILTERS_HPP_
+
+#include <Arduino.h>
+#include "FixedPoint.hpp"
+#include "Worker.hpp"
+
+/*
+ * Fixed point (Q16.16) filters and a process worker to apply them to the data of another worker.
+ * Each filter has a `push` for single samples and a `process` for blocks of samples. `process` is a loop over `push`
+ * (the filters carry state from sample to sample), it saves the call overhead per sample, not the per sample work.
+ */
+
+/**
+ * Moving average over the last N samples, O(1) per sample
+ * @tparam N: window size
+ */
+template<size_t N>
+class MovingAverage {
+ public:
+  MovingAverage() : samples(), sum(0), index(0), count(0) {
+  }
+
+  /**
+   * Add a sample
+   * @param sample: input
+   * @param out: average of the window
+   * @return true (always produces)
+   */
+  bool push(fixed_t sample, fixed_t& out) {
+    sum += (int64_t) sample - samples[index];
+    samples[index] = sample;
+    index = index + 1 == N ? 0 : index + 1;
+    if (count < N) {
+      ++count;
+    }
+    out = (fixed_t) (sum / (int64_t) count);
+    return true;
+  }
+
+  /**
+   * Filter a block of samples
+   * @return amount of output samples
+   */
+  size_t process(const fixed_t* in, fixed_t* out, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+      push(in[i], out[i]);
+    }
+    return length;
+  }
+
+  void reset() {
+    *this = MovingAverage();
+  }
+
+ private:
+  fixed_t samples[N];
+  int64_t sum;
+  size_t index;
+  size_t count;
+};
+
+/**
+ * Exponential moving average: y += alpha * (x - y)
+ */
+class ExponentialAverage {
+ public:
+  /**
+   * @param alpha: smoothing factor in fixed point (0 < alpha <= 1)
+   */
+  explicit ExponentialAverage(fixed_t alpha) : alpha(alpha), value(0), primed(false) {
+  }
+
+  bool push(fixed_t sample, fixed_t& out) {
+    if (!primed) {
+      value = sample;
+      primed = true;
+    } else {
+      value += fixed_mul(alpha, sample - value);
+    }
+    out = value;
+    return true;
+  }
+
+  size_t process(const fixed_t* in, fixed_t* out, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+      push(in[i], out[i]);
+    }
+    return length;
+  }
+
+  void reset() {
+    primed = false;
+  }
+
+ private:
+  fixed_t alpha;
+  fixed_t value;
+  bool primed;
+};
+
+/**
+ * Median over the last N samples, keeps a sorted copy of the window (O(N) per sample, N is expected to be small)
+ * @tparam N: window size
+ */
+template<size_t N>
+class SlidingMedian {
+ public:
+  SlidingMedian() : samples(), sorted(), index(0), count(0) {
+  }
+
+  bool push(fixed_t sample, fixed_t& out) {
+    if (count == N) {
+      remove_sorted(samples[index]);
+    } else {
+      ++count;
+    }
+    samples[index] = sample;
+    index = index + 1 == N ? 0 : index + 1;
+    insert_sorted(sample);
+    out = sorted[(count - 1) / 2];
+    return true;
+  }
+
+  size_t process(const fixed_t* in, fixed_t* out, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+      push(in[i], out[i]);
+    }
+    return length;
+  }
+
+  void reset() {
+    *this = SlidingMedian();
+  }
+
+ private:
+  void remove_sorted(fixed_t sample) {
+    size_t i = 0;
+    while (i < count && sorted[i] != sample) {
+      ++i;
+    }
+    for (; i + 1 < count; ++i) {
+      sorted[i] = sorted[i + 1];
+    }
+  }
+
+  void insert_sorted(fixed_t sample) {
+    // `count` already includes the new sample
+    size_t i = count - 1;
+    while (i > 0 && sorted[i - 1] > sample) {
+      sorted[i] = sorted[i - 1];
+      --i;
+    }
+    sorted[i] = sample;
+  }
+
+  fixed_t samples[N];
+  fixed_t sorted[N];
+  size_t index;
+  size_t count;
+};
+
+/**
+ * IIR biquad (direct form 1), coefficients in Q4.28 so low cutoffs keep their precision (the products stay under 2^60
+ * in the 64 bit accumulator). The rounding error of each output is fed back into the next one, so the error the
+ * feedback path amplifies at low cutoffs averages out instead of biasing the output
+ */
+class Biquad {
+ public:
+  static const uint8_t coefficient_bits = 28;
+
+  /**
+   * Normalized coefficients (a0 = 1)
+   */
+  struct Coefficients {
+    int32_t b0, b1, b2, a1, a2;
+
+    /**
+     * Convert float coefficients (normalized to a0 = 1)
+     */
+    static Coefficients from_float(float b0, float b1, float b2, float a1, float a2);
+
+    /**
+     * Convert double coefficients (normalized to a0 = 1), used by the cookbook filters: at low cutoffs the
+     * coefficients are differences of numbers close to 1 which float doesn't resolve
+     */
+    static Coefficients from_double(double b0, double b1, double b2, double a1, double a2);
+
+    /**
+     * Second order low pass (RBJ cookbook)
+     * @param cutoff: cutoff frequency in Hz
+     * @param sample_rate: sample rate in Hz
+     * @param q: quality factor (0.7071 for butterworth)
+     */
+    static Coefficients lowpass(float cutoff, float sample_rate, float q = 0.7071f);
+
+    /**
+     * Second order high pass (RBJ cookbook)
+     */
+    static Coefficients highpass(float cutoff, float sample_rate, float q = 0.7071f);
+  };
+
+  explicit Biquad(const Coefficients& coefficients)
+      : c(coefficients), x1(0), x2(0), y1(0), y2(0), error(0) {
+  }
+
+  bool push(fixed_t sample, fixed_t& out) {
+    int64_t acc = (int64_t) c.b0 * sample + (int64_t) c.b1 * x1 + (int64_t) c.b2 * x2
+        - (int64_t) c.a1 * y1 - (int64_t) c.a2 * y2 + error;
+    fixed_t y = (fixed_t) (acc >> coefficient_bits);
+    error = acc - ((int64_t) y << coefficient_bits);
+    x2 = x1;
+    x1 = sample;
+    y2 = y1;
+    y1 = y;
+    out = y;
+    return true;
+  }
+
+  size_t process(const fixed_t* in, fixed_t* out, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+      push(in[i], out[i]);
+    }
+    return length;
+  }
+
+  void reset() {
+    x1 = x2 = y1 = y2 = 0;
+    error = 0;
+  }
+
+ private:
+  Coefficients c;
+  fixed_t x1, x2, y1, y2;
+  int64_t error; // Part of the last output below the fixed point resolution
+};
+
+inline Biquad::Coefficients Biquad::Coefficients::from_float(float b0, float b1, float b2, float a1, float a2) {
+  return from_double(b0, b1, b2, a1, a2);
+}
+
+inline Biquad::Coefficients Biquad::Coefficients::from_double(double b0, double b1, double b2, double a1, double a2) {
+  const double scale = (double) (1 << coefficient_bits);
+  return Coefficients{
+      (int32_t) llround(b0 * scale),
+      (int32_t) llround(b1 * scale),
+      (int32_t) llround(b2 * scale),
+      (int32_t) llround(a1 * scale),
+      (int32_t) llround(a2 * scale)
+  };
+}
+
+inline Biquad::Coefficients Biquad::Coefficients::lowpass(float cutoff, float sample_rate, float q) {
+  double w0 = 2.0 * M_PI * cutoff / sample_rate;
+  double alpha = sin(w0) / (2.0 * q);
+  // 1 - cos(w0), without the cancellation
+  double one_minus_cos = 2.0 * sin(w0 / 2) * sin(w0 / 2);
+  double a0 = 1.0 + alpha;
+  return from_double(
+      one_minus_cos / 2.0 / a0,
+      one_minus_cos / a0,
+      one_minus_cos / 2.0 / a0,
+      -2.0 * cos(w0) / a0,
+      (1.0 - alpha) / a0
+  );
+}
+
+inline Biquad::Coefficients Biquad::Coefficients::highpass(float cutoff, float sample_rate, float q) {
+  double w0 = 2.0 * M_PI * cutoff / sample_rate;
+  double alpha = sin(w0) / (2.0 * q);
+  double cos_w0 = cos(w0);
+  double a0 = 1.0 + alpha;
+  return from_double(
+      (1.0 + cos_w0) / 2.0 / a0,
+      -(1.0 + cos_w0) / a0,
+      (1.0 + cos_w0) / 2.0 / a0,
+      -2.0 * cos_w0 / a0,
+      (1.0 - alpha) / a0
+  );
+}
+
+/**
+ * Averages every N samples into one output sample
+ * @tparam N: decimation factor
+ */
+template<size_t N>
+class Decimator {
+ public:
+  Decimator() : sum(0), count(0) {
+  }
+
+  bool push(fixed_t sample, fixed_t& out) {
+    sum += sample;
+    if (++count < N) {
+      return false;
+    }
+    out = (fixed_t) (sum / (int64_t) N);
+    sum = 0;
+    count = 0;
+    return true;
+  }
+
+  size_t process(const fixed_t* in, fixed_t* out, size_t length) {
+    size_t produced = 0;
+    for (size_t i = 0; i < length; ++i) {
+      if (push(in[i], out[produced])) {
+        ++produced;
+      }
+    }
+    return produced;
+  }
+
+  void reset() {
+    sum = 0;
+    count = 0;
+  }
+
+ private:
+  int64_t sum;
+  size_t count;
+};
+
+/**
+ * Process worker that applies a filter to a field of the data of another worker, whenever that worker is fresh.
+ * Produces the filter output in fixed point (fresh only when the filter produced output, see Decimator)
+ * @tparam T: data type of the source worker
+ * @tparam Filter: one of the filters above (or anything with `bool push(fixed_t, fixed_t&)`)
+ */
+template<typename T, typename Filter>
+class FilterWorker : public ProcessWorker<fixed_t> {
+ public:
+  /**
+   * Reads the field to filter from the source data, in fixed point
+   */
+  typedef fixed_t (*Accessor)(const T& data);
+
+  /**
+   * @param source_id : id of the worker to filter
+   * @param accessor : function to get the field to filter
+   * @param filter : the filter (with its configuration)
+   */
+  FilterWorker(uint8_t source_id, Accessor accessor, const Filter& filter = Filter())
+      : ProcessWorker<fixed_t>(0, 0), source_id(source_id), accessor(accessor), filter(filter) {
+  }
+
+  /**
+   * Get the filtered value as float
+   * @return
+   */
+  float get_value() const {
+    return from_fixed(data);
+  }
+
+ protected:
+  int8_t produce_data(const WorkerMap& workers) override {
+    auto source = workers.worker<Worker<T>>(source_id);
+    if (source && source->is_fresh() && filter.push(accessor(source->get_data()), data)) {
+      return e_worker_data_read;
+    }
+    return e_worker_idle;
+  }
+
+  bool activate(bool retry) override {
+    filter.reset();
+    return true;
+  }
+
+ private:
+  uint8_t source_id;
+  Accessor accessor;
+  Filter filter;
+};
+
+template<typename T, size_t N>
+using MovingAverageWorker = FilterWorker<T, MovingAverage<N>>;
+
+template<typename T>
+using ExponentialAverageWorker = FilterWorker<T, ExponentialAverage>;
+
+template<typename T, size_t N>
+using SlidingMedianWorker = FilterWorker<T, SlidingMedian<N>>;
+
+template<typename T>
+using BiquadWorker = FilterWorker<T, Biquad>;
+
+template<typename T, size_t N>
+using DecimatorWorker = FilterWorker<T, Decimator<N>>;
+
+#endif //SENSOR_REPORTER_FILTERS_HPP_
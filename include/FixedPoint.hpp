@@ -0,0 +1,46 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_FIXEDPOINT_HPP_
+#define SENSOR_REPORTER_FIXEDPOINT_HPP_
+
+#include <stdint.h>
+
+/**
+ * Signed Q16.16 fixed point value, used by the filter and calibration workers
+ */
+typedef int32_t fixed_t;
+
+#define FIXED_FRACTION_BITS 16
+#define FIXED_ONE ((fixed_t) 1 << FIXED_FRACTION_BITS)
+
+/**
+ * Convert a float to fixed point (rounded)
+ */
+constexpr fixed_t to_fixed(float value) {
+  return (fixed_t) (value * FIXED_ONE + (value < 0 ? -0.5f : 0.5f));
+}
+
+/**
+ * Convert an integer to fixed point
+ */
+constexpr fixed_t int_to_fixed(int32_t value) {
+  return (fixed_t) ((uint32_t) value << FIXED_FRACTION_BITS);
+}
+
+/**
+ * Convert fixed point to a float
+ */
+constexpr float from_fixed(fixed_t value) {
+  return (float) value / FIXED_ONE;
+}
+
+/**
+ * Multiply two fixed point values
+ */
+constexpr fixed_t fixed_mul(fixed_t a, fixed_t b) {
+  return (fixed_t) (((int64_t) a * b) >> FIXED_FRACTION_BITS);
+}
+
+#endif //SENSOR_REPORTER_FIXEDPOINT_HPP_
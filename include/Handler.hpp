@@ -6,9 +6,13 @@
 #define SENSOR_REPORTER_REPORTER_HPP_
 
 #include "Activatable.hpp"
+#include "CorePlacement.hpp"
+#include "LatencyHistogram.hpp"
+#include "TickSnapshot.hpp"
 #include "Worker.hpp"
 #include <Arduino.h>
 #include <map>
+#include <vector>
 
 class Aggregator;
 
@@ -35,7 +39,7 @@ class Handler : public Activatable {
    * Construct a handler
    */
   explicit Handler();
-  virtual ~Handler() = default;
+  virtual ~Handler();
 
   /**
    * get current status
@@ -43,6 +47,32 @@ class Handler : public Activatable {
    */
   int8_t get_status() const;
 
+  /**
+   * Get the id this handler is registered with in the aggregator
+   * @return
+   */
+  uint8_t get_id() const;
+
+  /**
+   * Measure per worker how old fresh data is when this handler handled it: from the produce time of the worker to the
+   * moment the status becomes e_handler_data_handled (after the async task, if any). Disabled by default
+   * @param enabled
+   */
+  void set_latency_tracking(bool enabled);
+
+  /**
+   * Get the latency histogram of the data of a worker. In pipelined mode it may be updated while it is read
+   * @param worker_id
+   * @return nullptr if nothing of the worker was handled (with tracking enabled)
+   */
+  const LatencyHistogram* get_latency(uint8_t worker_id) const;
+
+  /**
+   * Write the latency summary of every worker, a line each
+   * @param out : like Serial
+   */
+  void dump_latencies(Print& out) const;
+
  protected:
   /**
    * Handle the data produced by workers
@@ -51,6 +81,28 @@ class Handler : public Activatable {
    */
   virtual int8_t handle_produced_work(const WorkerMap& workers) = 0;
 
+  /**
+   * Handle the data produced by workers in pipelined mode (see Aggregator::enable_pipelining). Called from the
+   * pipeline task, while the workers are already producing the next tick. Only read the workers through the snapshot.
+   * @param snapshot: copy of the state of the workers
+   * @return status code (HandlerStatus::StatusCode or any custom)
+   */
+  virtual int8_t handle_produced_snapshot(const TickSnapshot& snapshot);
+
+  /**
+   * Checks if the handler implements handle_produced_snapshot. In pipelined mode, handlers that don't keep handling
+   * the workers on the aggregator task
+   * @return false by default, override it together with handle_produced_snapshot
+   */
+  virtual bool handles_snapshots() const;
+
+  /**
+   * Checks if the handler is called on every run, also without fresh data (for handlers with timers or connections to
+   * service, like HttpUplinkHandler). handle_produced_work then checks for fresh data itself
+   * @return false by default
+   */
+  virtual bool handles_every_run() const;
+
   /**
    * Handle data async, prepare your data internally in the handler
    * @return status code (HandlerStatus::StatusCode or any custom)
@@ -64,11 +116,12 @@ class Handler : public Activatable {
   /**
    * Start task running async to perform the data handling (prepare data beforehand in handler instance)
    * @param task_name
-   * @param core
+   * @param core : core to pin the task to, by default the least loaded core (see CorePlacement)
    * @param priority
    * @return
    */
-  int8_t start_task(const char* task_name, uint32_t memory=1024, uint8_t priority=5, uint8_t core=0);
+  int8_t start_task(const char* task_name, uint32_t memory=1024, uint8_t priority=5,
+                    uint8_t core=CorePlacement::core_auto);
 
   /**
    * Kill a running task
@@ -77,6 +130,13 @@ class Handler : public Activatable {
 
   virtual bool task_running() const;
 
+  /**
+   * Continue async handling that runs on the aggregator task instead of in its own task (see CoHandler). Called every
+   * run while the handler is processing and no task is running
+   * @return status code, e_handler_processing while the handling is not finished
+   */
+  virtual int8_t resume_async();
+
  private:
 
   /**
@@ -86,8 +146,45 @@ class Handler : public Activatable {
    */
   virtual void try_handle_work(const WorkerMap& workers) final;
 
+  /**
+   * Call the data handler sequence with a snapshot (pipelined mode)
+   * @param snapshot: snapshot to handle, nullptr to only finish async handling
+   */
+  void try_handle_snapshot(const TickSnapshot* snapshot);
+
+  /**
+   * Shared part of the handler sequence
+   * @return true if the handler is ready to handle new data
+   */
+  bool prepare_handling();
+
+  /**
+   * Remember the produce times of the fresh workers the handling started with
+   */
+  void tag_latency(const WorkerMap& workers);
+  void tag_latency(const TickSnapshot& snapshot);
+
+  /**
+   * Record the latency of the remembered produce times, when handled
+   */
+  void record_latency();
+
   static void run_task(void* instance);
   TaskHandle_t xAsyncHandlerHandle;
+  uint8_t task_core;
+  uint32_t task_started;
+  uint8_t id;
+
+  struct LatencyTag {
+    uint8_t worker_id;
+    uint32_t produce_micros;
+  };
+
+  bool latency_tracking;
+  std::vector<LatencyTag> latency_tags;
+  std::map<uint8_t, LatencyHistogram> latencies;
+  // Guards the latencies map: handlers record on the pipeline task in pipelined mode, while it is read on others
+  SemaphoreHandle_t latencies_mutex;
 
   friend Aggregator;
 };
@@ -0,0 +1,162 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_HTTPUPLINKHANDLER_HPP_
+#define SENSOR_REPORTER_HTTPUPLINKHANDLER_HPP_
+
+#include <Arduino.h>
+#include <vector>
+#include "Handler.hpp"
+#include "UplinkTransport.hpp"
+
+/**
+ * Handler that uploads records to an HTTP API in batches over a persistent (keep-alive) connection.
+ * Every run with fresh data, `encode_record` is asked for a record (like a JSON object) which is queued. Once enough
+ * records are queued (or the oldest record waited long enough) they are POSTed as one JSON array. Requests are written
+ * without waiting for the response, up to `max_in_flight` requests are pipelined when the server keeps the connection
+ * alive. Responses are read on the following runs, nothing blocks on the network. The handler is called on every run
+ * (see Handler::handles_every_run), so the delay and the responses are also handled while no worker is fresh; the
+ * resolution of max_delay is the time between runs.
+ * When the connection is lost, the handler deactivates and reconnects through activate(retry) with exponential backoff.
+ * Batches stay in the queue until their response arrives, batches without a response are sent again after
+ * reconnecting (so a batch may arrive twice). A record is only dropped when the queue has no room for it, or when the
+ * server rejects its batch.
+ */
+class HttpUplinkHandler : public Handler {
+ public:
+  typedef enum Status {
+    e_uplink_connection_lost = e_handler_error + 1,
+    e_uplink_queue_full,
+  } Status;
+
+  struct Stats {
+    uint32_t records_queued;
+    uint32_t records_sent; // Acknowledged with a 2xx response
+    uint32_t records_dropped; // Queue full or batch rejected by the server
+    uint32_t requests; // Including batches sent again after reconnecting
+    uint32_t failed_requests;
+    uint32_t connection_losses;
+  };
+
+  /**
+   * @param transport : connection to the server
+   * @param host : value of the host header
+   * @param path : path to POST the batches to
+   * @param queue_size : bytes available for queued records, including batches waiting for their response
+   * @param batch_records : amount of records per request
+   * @param max_delay_millis : maximum time a record waits in the queue before a (smaller) batch is sent
+   */
+  HttpUplinkHandler(UplinkTransport& transport, const char* host, const char* path, size_t queue_size = 1024,
+                    uint16_t batch_records = 10, uint32_t max_delay_millis = 10000);
+
+  /**
+   * Set an extra header line sent with every request (like "Authorization: Bearer ...", without line ending)
+   * @param header : must outlive the handler
+   */
+  void set_extra_header(const char* header);
+
+  /**
+   * Limit the amount of requests that are sent before their response arrived (default 4)
+   * @param max_in_flight
+   */
+  void set_max_in_flight(uint8_t max_in_flight);
+
+  /**
+   * Set the reconnect backoff
+   * @param initial_millis : wait after the first failed attempt
+   * @param max_millis : maximum wait between attempts
+   */
+  void set_backoff(uint32_t initial_millis, uint32_t max_millis);
+
+  /**
+   * Get the uplink statistics
+   * @return
+   */
+  const Stats& get_stats() const;
+
+ protected:
+  /**
+   * Encode a record for the fresh data (like `{"temp":21.5}`)
+   * @param workers
+   * @param buffer : buffer to write the record into
+   * @param capacity : size of the buffer
+   * @return length of the record, 0 if there is nothing to record. Like snprintf, capacity or more if it does not fit
+   */
+  virtual size_t encode_record(const WorkerMap& workers, char* buffer, size_t capacity) = 0;
+
+  bool activate(bool retry) override;
+  void deactivate() override;
+  int8_t handle_produced_work(const WorkerMap& workers) override;
+  bool handles_every_run() const override;
+
+ private:
+  struct Response {
+    enum State {
+      e_status_line,
+      e_headers,
+      e_body,
+    } state;
+    char line[96];
+    size_t line_length;
+    int status_code;
+    uint32_t content_length;
+    bool close;
+  };
+
+  struct Batch {
+    uint16_t records;
+    size_t bytes;
+  };
+
+  /**
+   * Queue a record for the fresh data
+   * @return status of the handler for this run
+   */
+  int8_t queue_record(const WorkerMap& workers);
+
+  /**
+   * Close the pending records into a batch
+   */
+  void close_batch();
+
+  /**
+   * Send the first batch that was not sent on this connection
+   * @return false if the connection failed
+   */
+  bool send_batch();
+  void read_responses();
+  void handle_response_line();
+  void finish_response();
+  bool write_all(const uint8_t* buffer, size_t length);
+
+  UplinkTransport& transport;
+  const char* host;
+  const char* path;
+  const char* extra_header;
+
+  // Batches (oldest first) followed by the pending records
+  std::vector<char> queue;
+  size_t queue_used;
+  uint16_t queued_records; // Pending records, not in a batch yet
+  uint16_t batch_records;
+  uint32_t max_delay;
+  uint32_t oldest_record;
+
+  // Batches waiting for a response, oldest first. The first `in_flight` were sent on this connection
+  std::vector<Batch> batches;
+  size_t batched_bytes;
+  uint8_t in_flight;
+  uint8_t max_in_flight;
+  bool pipelining;
+  Response response;
+
+  uint32_t backoff_initial;
+  uint32_t backoff_max;
+  uint32_t backoff;
+  uint32_t next_attempt;
+
+  Stats stats;
+};
+
+#endif //SENSOR_REPORTER_HTTPUPLINKHANDLER_HPP_
@@ -0,0 +1,287 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_JOINWORKER_HPP_
+#define SENSOR_REPORTER_JOINWORKER_HPP_
+
+#include <Arduino.h>
+#include "Clock.hpp"
+#include "Worker.hpp"
+
+/**
+ * When a join worker combines the samples of its sources into a record
+ */
+typedef enum JoinPolicy {
+  e_join_window, // When every source has a new sample and they are all within the window of each other
+  e_join_nearest, // For every sample of source 0, with the nearest sample of the other sources (within the window)
+  e_join_interpolate, // For every sample of source 0, with the other sources interpolated to its timestamp
+} JoinPolicy;
+
+/**
+ * Fused samples of the sources of a join worker
+ * @tparam N: amount of sources
+ */
+template<size_t N>
+struct JoinRecord {
+  uint32_t timestamp; // Common timestamp of the values
+  float values[N];
+  int32_t offsets[N]; // Timestamp of the sample used (the farthest one when interpolated) minus the common timestamp
+  uint32_t skew; // Largest distance between a sample used and the common timestamp
+};
+
+/**
+ * Process worker that fuses the samples of N sources running at different rates (or async) into records with a common
+ * timestamp. A sample is a value read from a source when it is fresh, with its produce time. The last `History`
+ * samples of every source are kept, so sources don't need to be fresh in the same run. Every record reports how far
+ * the samples it used are from its timestamp (see JoinRecord).
+ * @tparam N: amount of sources
+ * @tparam History: samples kept per source (for nearest and interpolate)
+ */
+template<size_t N, size_t History = 4>
+class JoinWorker : public ProcessWorker<JoinRecord<N>> {
+ public:
+  /**
+   * Reads the value to join from a source worker (cast it to its type)
+   */
+  typedef float (*Accessor)(const BaseWorker& worker);
+
+  /**
+   * @param policy : when to produce a record
+   * @param window_millis : window: maximum skew between the samples. nearest: maximum distance of the nearest sample
+   * (0 for no limit). interpolate: how long to wait for a later sample of every source before using the last one
+   */
+  JoinWorker(JoinPolicy policy, uint32_t window_millis)
+      : ProcessWorker<JoinRecord<N>>(), policy(policy), window(window_millis), sources(), pending(false),
+        target(), dropped(0) {
+  }
+
+  /**
+   * Set a source
+   * @param index : index of the source in the records (source 0 is the reference for nearest and interpolate)
+   * @param worker_id : id of the worker
+   * @param accessor : function to read the value from the worker
+   */
+  void set_source(size_t index, uint8_t worker_id, Accessor accessor) {
+    if (index < N) {
+      sources[index].worker_id = worker_id;
+      sources[index].accessor = accessor;
+      sources[index].count = 0;
+      sources[index].updated = false;
+    }
+  }
+
+  /**
+   * Samples (or reference samples) that could not be joined within the window
+   * @return
+   */
+  uint32_t get_dropped() const {
+    return dropped;
+  }
+
+ protected:
+  int8_t produce_data(const WorkerMap& workers) override {
+    collect(workers);
+    bool joined;
+    switch (policy) {
+      case e_join_window:
+        joined = join_window();
+        break;
+      case e_join_nearest:
+        joined = join_nearest();
+        break;
+      default:
+        joined = join_interpolate();
+        break;
+    }
+    return joined ? BaseWorker::e_worker_data_read : BaseWorker::e_worker_idle;
+  }
+
+ private:
+  struct Sample {
+    uint32_t timestamp;
+    float value;
+  };
+
+  struct Source {
+    uint8_t worker_id;
+    Accessor accessor;
+    Sample history[History]; // Oldest first
+    size_t count;
+    bool updated; // New sample since the last record
+  };
+
+  void collect(const WorkerMap& workers) {
+    for (Source& source : sources) {
+      if (!source.accessor) {
+        continue;
+      }
+      auto it = workers.find(source.worker_id);
+      if (it == workers.end() || !it->second->is_fresh()) {
+        continue;
+      }
+      if (source.count == History) {
+        memmove(source.history, source.history + 1, sizeof(Sample) * (History - 1));
+        --source.count;
+      }
+      source.history[source.count++] = Sample{it->second->get_last_produce(), source.accessor(*it->second)};
+      source.updated = true;
+    }
+  }
+
+  const Sample& latest(const Source& source) const {
+    return source.history[source.count - 1];
+  }
+
+  /**
+   * Sample of a source nearest to a timestamp
+   */
+  const Sample& nearest(const Source& source, uint32_t timestamp) const {
+    const Sample* best = &source.history[0];
+    for (size_t i = 1; i < source.count; ++i) {
+      if (distance(source.history[i].timestamp, timestamp) < distance(best->timestamp, timestamp)) {
+        best = &source.history[i];
+      }
+    }
+    return *best;
+  }
+
+  static uint32_t distance(uint32_t a, uint32_t b) {
+    auto difference = (int32_t) (a - b);
+    return difference < 0 ? (uint32_t) -difference : (uint32_t) difference;
+  }
+
+  void set_value(size_t index, float value, uint32_t sample_timestamp) {
+    this->data.values[index] = value;
+    this->data.offsets[index] = (int32_t) (sample_timestamp - this->data.timestamp);
+    uint32_t age = distance(sample_timestamp, this->data.timestamp);
+    if (age > this->data.skew) {
+      this->data.skew = age;
+    }
+  }
+
+  bool join_window() {
+    for (const Source& source : sources) {
+      if (!source.updated) {
+        return false;
+      }
+    }
+    uint32_t newest = latest(sources[0]).timestamp;
+    for (const Source& source : sources) {
+      if ((int32_t) (latest(source).timestamp - newest) > 0) {
+        newest = latest(source).timestamp;
+      }
+    }
+    bool stale = false;
+    for (Source& source : sources) {
+      if (newest - latest(source).timestamp > window) {
+        // Too old to be joined with the newest sample, wait for a new one
+        source.updated = false;
+        stale = true;
+        ++dropped;
+      }
+    }
+    if (stale) {
+      return false;
+    }
+    this->data.timestamp = newest;
+    this->data.skew = 0;
+    for (size_t i = 0; i < N; ++i) {
+      set_value(i, latest(sources[i]).value, latest(sources[i]).timestamp);
+      sources[i].updated = false;
+    }
+    return true;
+  }
+
+  bool join_nearest() {
+    Source& reference = sources[0];
+    if (!reference.updated) {
+      return false;
+    }
+    reference.updated = false;
+    Sample sample = latest(reference);
+    for (size_t i = 1; i < N; ++i) {
+      if (sources[i].count == 0 || (window && distance(nearest(sources[i], sample.timestamp).timestamp,
+                                                       sample.timestamp) > window)) {
+        ++dropped;
+        return false;
+      }
+    }
+    this->data.timestamp = sample.timestamp;
+    this->data.skew = 0;
+    set_value(0, sample.value, sample.timestamp);
+    for (size_t i = 1; i < N; ++i) {
+      const Sample& match = nearest(sources[i], sample.timestamp);
+      set_value(i, match.value, match.timestamp);
+      sources[i].updated = false;
+    }
+    return true;
+  }
+
+  bool join_interpolate() {
+    Source& reference = sources[0];
+    if (reference.updated) {
+      if (pending) {
+        // Previous reference sample never got a later sample of every source
+        ++dropped;
+      }
+      reference.updated = false;
+      target = latest(reference);
+      pending = true;
+    }
+    if (!pending) {
+      return false;
+    }
+    bool timed_out = Clock::get().millis() - target.timestamp > window;
+    for (size_t i = 1; i < N; ++i) {
+      if (sources[i].count == 0 || ((int32_t) (latest(sources[i]).timestamp - target.timestamp) < 0 && !timed_out)) {
+        // Wait for a sample after the target
+        return false;
+      }
+    }
+    pending = false;
+    this->data.timestamp = target.timestamp;
+    this->data.skew = 0;
+    set_value(0, target.value, target.timestamp);
+    for (size_t i = 1; i < N; ++i) {
+      interpolate(i);
+      sources[i].updated = false;
+    }
+    return true;
+  }
+
+  void interpolate(size_t index) {
+    const Source& source = sources[index];
+    uint32_t timestamp = target.timestamp;
+    const Sample* before = nullptr;
+    const Sample* after = nullptr;
+    for (size_t i = 0; i < source.count; ++i) {
+      auto offset = (int32_t) (source.history[i].timestamp - timestamp);
+      if (offset <= 0) {
+        before = &source.history[i];
+      } else if (!after) {
+        after = &source.history[i];
+      }
+    }
+    if (before && after) {
+      float fraction = (float) (timestamp - before->timestamp) / (float) (after->timestamp - before->timestamp);
+      float value = before->value + (after->value - before->value) * fraction;
+      // Report the farthest of the two samples the value was interpolated from
+      set_value(index, value, timestamp - before->timestamp > after->timestamp - timestamp
+                              ? before->timestamp : after->timestamp);
+    } else {
+      // Only samples on one side (timed out or history too short), hold the nearest
+      const Sample& sample = before ? *before : *after;
+      set_value(index, sample.value, sample.timestamp);
+    }
+  }
+
+  JoinPolicy policy;
+  uint32_t window;
+  Source sources[N];
+  bool pending;
+  Sample target;
+  uint32_t dropped;
+};
+
+#endif //SENSOR_REPORTER_JOINWORKER_HPP_
@@ -0,0 +1,72 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_LATENCYHISTOGRAM_HPP_
+#define SENSOR_REPORTER_LATENCYHISTOGRAM_HPP_
+
+#include <Arduino.h>
+
+/**
+ * Fixed memory histogram of latencies in micros. Log-linear buckets: 4 per power of 2, so a bucket is at most 25%
+ * wide over the full 32 bit range. Count, mean and max are exact, percentiles are the upper bound of their bucket.
+ * When a bucket is full, all buckets are halved so recent samples keep their weight.
+ */
+class LatencyHistogram {
+ public:
+  static const uint8_t sub_bucket_bits = 2;
+  static const uint8_t bucket_count = (32 - sub_bucket_bits + 1) << sub_bucket_bits;
+
+  LatencyHistogram();
+
+  /**
+   * Add a sample
+   * @param micros : latency
+   */
+  void record(uint32_t micros);
+
+  /**
+   * Latency below which a fraction of the samples are
+   * @param fraction : like 0.5 for the median, 0.99 for p99
+   * @return latency in micros, 0 without samples
+   */
+  uint32_t percentile(float fraction) const;
+
+  /**
+   * Amount of samples recorded
+   * @return
+   */
+  uint32_t get_count() const;
+
+  /**
+   * Mean latency in micros
+   * @return
+   */
+  uint32_t get_mean() const;
+
+  /**
+   * Highest latency in micros
+   * @return
+   */
+  uint32_t get_max() const;
+
+  void reset();
+
+  /**
+   * Write a summary line: count, p50, p95, p99 and max
+   * @param out
+   */
+  void dump(Print& out) const;
+
+ private:
+  static uint8_t bucket_index(uint32_t micros);
+  static uint32_t bucket_upper_bound(uint8_t index);
+
+  uint16_t counts[bucket_count];
+  uint32_t total; // Sum of the bucket counts
+  uint32_t count;
+  uint64_t sum;
+  uint32_t max;
+};
+
+#endif //SENSOR_REPORTER_LATENCYHISTOGRAM_HPP_
@@ -0,0 +1,166 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_OUTPUTSINK_HPP_
+#define SENSOR_REPORTER_OUTPUTSINK_HPP_
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * One record in the ring of an OutputSink
+ */
+struct OutputSlot {
+  std::atomic<uint32_t> sequence;
+  uint16_t length;
+};
+
+/**
+ * Non blocking output: workers, handlers, supervisors and async tasks write records into a lock free ring (multiple
+ * producers), a low priority drain task writes them to the underlying output (like Serial). When the ring is full the
+ * record is dropped and counted instead of waiting for the output.
+ *
+ * Every write (or printf) is one record of at most the slot size, longer writes are split over several records which
+ * may interleave with records of other writers. Writing single bytes (print of a number) takes a record per byte, use
+ * printf. Use FixedOutputSink to get the storage.
+ */
+class OutputSink : public Print {
+ public:
+  struct Stats {
+    uint32_t records; // Records written to the ring
+    uint32_t dropped; // Records dropped because the ring was full
+    uint32_t truncated; // Printf records cut to the slot size
+    uint32_t drained; // Records written to the output
+  };
+
+  /**
+   * @param out : output to drain to, must outlive the sink
+   * @param slots : slot_count slots
+   * @param text : slot_count * slot_size bytes
+   * @param slot_count : amount of records the ring holds, a power of 2 (asserted)
+   * @param slot_size : maximum size of a record
+   */
+  OutputSink(Print& out, OutputSlot* slots, char* text, uint16_t slot_count, uint16_t slot_size);
+  ~OutputSink() override;
+
+  /**
+   * Write a record, never blocks
+   * @return length if it was written (split into records if longer than a slot), 0 if dropped
+   */
+  size_t write(const uint8_t* buffer, size_t length) override;
+  size_t write(uint8_t byte) override;
+  using Print::write;
+
+  /**
+   * Format a record straight into the ring, never blocks
+   * @return length of the record, 0 if dropped
+   */
+  size_t printf(const char* format, ...) __attribute__ ((format (printf, 2, 3)));
+
+  /**
+   * Write records from the ring to the output. Called by the drain task, or from the loop when no task is started
+   * @param max_records : maximum amount of records to write, 0 for all
+   * @return amount of records written
+   */
+  uint32_t drain(uint32_t max_records = 0);
+
+  /**
+   * Start a task that drains the ring
+   * @param poll_millis : time to wait when the ring is empty
+   * @param priority : keep it below the aggregator and other tasks doing work
+   * @param core
+   * @param memory : stack size
+   * @return true if the task was started
+   */
+  bool start_drain(uint32_t poll_millis = 10, uint8_t priority = 1, uint8_t core = 0, uint32_t memory = 2048);
+
+  /**
+   * Stop the drain task, waits for the current drain to end
+   */
+  void stop_drain();
+
+  /**
+   * Amount of records waiting to be drained
+   * @return
+   */
+  uint32_t pending() const;
+
+  /**
+   * Get a copy of the statistics
+   * @return
+   */
+  Stats get_stats() const;
+
+ private:
+  /**
+   * Claim a free slot
+   * @param position : receives the position of the slot in the ring
+   * @return false if the ring is full
+   */
+  bool claim(uint32_t& position);
+  void publish(uint32_t position, size_t length);
+
+  static void run_drain(void* instance);
+
+  Print& out;
+  OutputSlot* slots;
+  char* text;
+  uint16_t slot_count;
+  uint16_t slot_size;
+  std::atomic<uint32_t> enqueue_position;
+  std::atomic<uint32_t> dequeue_position;
+  std::atomic<uint32_t> records;
+  std::atomic<uint32_t> dropped;
+  std::atomic<uint32_t> truncated;
+  std::atomic<uint32_t> drained;
+  TaskHandle_t drain_task;
+  SemaphoreHandle_t drain_done;
+  uint32_t drain_poll;
+  std::atomic<bool> stop_requested;
+};
+
+/**
+ * Storage of a FixedOutputSink, a base listed before OutputSink so it exists when OutputSink initializes the slots
+ */
+template<uint16_t SlotCount, uint16_t SlotSize>
+struct OutputStorage {
+  OutputSlot storage_slots[SlotCount];
+  char storage_text[SlotCount * SlotSize];
+};
+
+/**
+ * OutputSink with its own storage
+ * @tparam SlotCount : amount of records, a power of 2
+ * @tparam SlotSize : maximum size of a record
+ */
+template<uint16_t SlotCount, uint16_t SlotSize = 64>
+class FixedOutputSink : private OutputStorage<SlotCount, SlotSize>, public OutputSink {
+  static_assert(SlotCount && (SlotCount & (SlotCount - 1)) == 0, "SlotCount must be a power of 2");
+
+ public:
+  explicit FixedOutputSink(Print& out)
+      : OutputStorage<SlotCount, SlotSize>(),
+        OutputSink(out, this->storage_slots, this->storage_text, SlotCount, SlotSize) {
+  }
+};
+
+/**
+ * Output that only counts what is written, stands in for a slow output when testing producers
+ */
+class CountingOutput : public Print {
+ public:
+  CountingOutput();
+
+  size_t write(uint8_t byte) override;
+  size_t write(const uint8_t* buffer, size_t length) override;
+
+  uint32_t get_bytes() const;
+  uint32_t get_writes() const;
+
+ private:
+  uint32_t bytes;
+  uint32_t writes;
+};
+
+#endif //SENSOR_REPORTER_OUTPUTSINK_HPP_
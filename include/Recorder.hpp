@@ -0,0 +1,148 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_RECORDER_HPP_
+#define SENSOR_REPORTER_RECORDER_HPP_
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+#include "Clock.hpp"
+#include "Handler.hpp"
+#include "Worker.hpp"
+
+/**
+ * Handler that records every fresh worker output with its produce timestamp in a compact binary log.
+ * Format: "SRRC", u8 version, followed by records of
+ *   u8 worker id, varint milliseconds since previous record, varint data size, raw data
+ * Workers whose data can't be copied as raw bytes (see is_raw_copyable, like String data) are not recorded.
+ */
+class WorkRecorder : public Handler {
+ public:
+  /**
+   * @param output : where to write the log to (like a file or Serial)
+   */
+  explicit WorkRecorder(Print& output);
+
+  /**
+   * Only record the given worker, can be called multiple times. Records all workers if never called
+   * @param worker_id
+   */
+  void record_worker(uint8_t worker_id);
+
+  /**
+   * Amount of records written
+   * @return
+   */
+  uint32_t get_record_count() const;
+
+ protected:
+  bool activate(bool retry) override;
+  int8_t handle_produced_work(const WorkerMap& workers) override;
+
+ private:
+  void write_varint(uint32_t value);
+
+  Print& output;
+  std::vector<uint8_t> filter;
+  uint32_t last_timestamp;
+  uint32_t record_count;
+};
+
+/**
+ * Worker that reads a log written by WorkRecorder and releases the records when they are due according to the
+ * framework clock (see Clock). Register this worker with a lower id than the replay workers that consume it.
+ * - With the system clock, records are replayed in real time
+ * - With an accelerated VirtualClock, records are replayed at that speed
+ * - With a driven VirtualClock (see drive_clock), the clock jumps to each next record, replaying as fast as possible
+ * Produces the amount of records released this tick.
+ */
+class ReplayReader : public Worker<uint16_t> {
+ public:
+  /**
+   * @param input : stream containing the recording
+   */
+  explicit ReplayReader(Stream& input);
+
+  /**
+   * Let the reader advance the virtual clock to the next record whenever nothing is due
+   * @param clock
+   */
+  void drive_clock(VirtualClock& clock);
+
+  /**
+   * Take the released data of a recorded worker
+   * @param worker_id : id of the recorded worker
+   * @param out : destination
+   * @param size : size of the destination, must match the recorded size
+   * @return true if fresh data was copied
+   */
+  bool take(uint8_t worker_id, void* out, size_t size);
+
+  /**
+   * Whether the end of the recording has been reached
+   * @return
+   */
+  bool finished() const;
+
+ protected:
+  bool activate(bool retry) override;
+  int8_t produce_data() override;
+
+ private:
+  struct Slot {
+    std::vector<uint8_t> bytes;
+    bool fresh;
+  };
+
+  bool read_next();
+  bool read_varint(uint32_t& value);
+
+  Stream& input;
+  VirtualClock* driven_clock;
+  std::map<uint8_t, Slot> slots;
+
+  // Next record that is not yet released
+  bool pending;
+  bool end_of_log;
+  uint8_t pending_id;
+  uint32_t pending_timestamp;
+  std::vector<uint8_t> pending_bytes;
+
+  uint32_t recorded_time;
+  uint32_t time_offset;
+};
+
+/**
+ * Worker that produces the recorded data of a worker, to be used in place of that worker
+ * @tparam T: Type of the data of the recorded worker
+ */
+template<typename T>
+class ReplayWorker : public ProcessWorker<T> {
+  static_assert(is_raw_copyable<T>::value, "Only data that is copied as raw bytes can be recorded and replayed");
+
+ public:
+  /**
+   * @param reader_id : id of the ReplayReader in the aggregator
+   * @param recorded_id : id of the worker in the recording
+   */
+  ReplayWorker(uint8_t reader_id, uint8_t recorded_id)
+      : ProcessWorker<T>(), reader_id(reader_id), recorded_id(recorded_id) {
+  }
+
+ protected:
+  int8_t produce_data(const WorkerMap& workers) override {
+    auto reader = workers.worker<ReplayReader>(reader_id);
+    if (reader->is_fresh() && reader->take(recorded_id, &this->data, sizeof(T))) {
+      return BaseWorker::e_worker_data_read;
+    }
+    return BaseWorker::e_worker_idle;
+  }
+
+ private:
+  uint8_t reader_id;
+  uint8_t recorded_id;
+};
+
+#endif //SENSOR_REPORTER_RECORDER_HPP_
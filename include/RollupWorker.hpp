@@ -0,0 +1,138 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_ROLLUPWORKER_HPP_
+#define SENSOR_REPORTER_ROLLUPWORKER_HPP_
+
+#include <Arduino.h>
+#include "Clock.hpp"
+#include "Worker.hpp"
+
+/**
+ * Summary of the samples in one time bucket
+ * @tparam V: value type
+ * @tparam S: type used to sum the values (use a wider type for integers)
+ */
+template<typename V, typename S = V>
+struct Rollup {
+  uint32_t bucket_start; // On the framework clock (millis)
+  uint32_t count;
+  V min;
+  V max;
+  S sum;
+  V first;
+  V last;
+
+  /**
+   * Mean of the bucket
+   * @return
+   */
+  float mean() const {
+    return count ? (float) sum / count : 0;
+  }
+};
+
+/**
+ * Process worker that summarizes a field of another worker per fixed time bucket (min/max/sum/count/first/last).
+ * Buckets are aligned to multiples of the bucket duration on the 32 bit millis of the framework clock (uptime, see
+ * Clock), which wraps after about 49 days. Use set_alignment to align them to wall clock time instead (calendar
+ * minutes, hours). The worker is fresh once per bucket, when the bucket closes: on the first run after the bucket ended.
+ * Buckets without samples are not produced.
+ * @tparam T: data type of the source worker
+ * @tparam V: value type of the summarized field
+ * @tparam S: type used to sum the values
+ */
+template<typename T, typename V, typename S = V>
+class RollupWorker : public ProcessWorker<Rollup<V, S>> {
+ public:
+  /**
+   * Reads the field to summarize from the source data
+   */
+  typedef V (*Accessor)(const T& data);
+
+  /**
+   * @param source_id : id of the worker to summarize
+   * @param accessor : function to get the field to summarize
+   * @param bucket_millis : duration of a bucket (like 60000 for per minute summaries)
+   */
+  RollupWorker(uint8_t source_id, Accessor accessor, uint32_t bucket_millis)
+      : ProcessWorker<Rollup<V, S>>(), source_id(source_id), accessor(accessor), bucket_millis(bucket_millis),
+        alignment(0), last_timestamp(0), current() {
+  }
+
+  /**
+   * Align buckets to wall clock time: after this, buckets start at multiples of the bucket duration in wall clock time
+   * (like whole minutes for 60000). Bucket starts stay on the framework clock. The alignment is kept over the wrap of
+   * the framework clock, call again after a time sync.
+   * @param wall_millis : wall clock time in millis (like unix time * 1000)
+   * @param at_millis : framework clock millis at that wall clock time
+   */
+  void set_alignment(uint64_t wall_millis, uint32_t at_millis) {
+    alignment = (uint32_t) ((wall_millis - at_millis) % bucket_millis);
+  }
+
+  /**
+   * Get the summary of the bucket that is still open
+   * @return
+   */
+  const Rollup<V, S>& get_open_bucket() const {
+    return current;
+  }
+
+ protected:
+  int8_t produce_data(const WorkerMap& workers) override {
+    bool closed = false;
+    uint32_t now = Clock::get().millis();
+    if (current.count && now - current.bucket_start >= bucket_millis) {
+      close_bucket();
+      closed = true;
+    }
+    auto source = workers.worker<Worker<T>>(source_id);
+    if (source && source->is_fresh()) {
+      uint32_t timestamp = source->get_last_produce();
+      if (current.count && timestamp - current.bucket_start >= bucket_millis) {
+        // Sample belongs to a later bucket than the one still open
+        close_bucket();
+        closed = true;
+      }
+      add_sample(timestamp, accessor(source->get_data()));
+    }
+    return closed ? BaseWorker::e_worker_data_read : BaseWorker::e_worker_idle;
+  }
+
+ private:
+  void close_bucket() {
+    this->data = current;
+    current.count = 0;
+  }
+
+  void add_sample(uint32_t timestamp, V value) {
+    if (timestamp < last_timestamp) {
+      // The framework clock wrapped, 2^32 is not a multiple of the bucket duration
+      alignment = (uint32_t) ((alignment + ((uint64_t) 1 << 32)) % bucket_millis);
+    }
+    last_timestamp = timestamp;
+    if (current.count == 0) {
+      current.bucket_start = timestamp - (uint32_t) (((uint64_t) timestamp + alignment) % bucket_millis);
+      current.min = current.max = current.first = value;
+      current.sum = 0;
+    } else if (value < current.min) {
+      current.min = value;
+    } else if (value > current.max) {
+      current.max = value;
+    }
+    current.sum += value;
+    current.last = value;
+    ++current.count;
+  }
+
+  uint8_t source_id;
+  Accessor accessor;
+  uint32_t bucket_millis;
+  uint32_t alignment; // Wall clock time - framework clock time, modulo the bucket duration
+  uint32_t last_timestamp;
+  Rollup<V, S> current;
+};
+
+#endif //SENSOR_REPORTER_ROLLUPWORKER_HPP_
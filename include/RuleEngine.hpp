@@ -0,0 +1,188 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_RULEENGINE_HPP_
+#define SENSOR_REPORTER_RULEENGINE_HPP_
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+#include "Worker.hpp"
+
+/**
+ * Raised or cleared alert of a rule
+ */
+struct RuleAlert {
+  uint16_t rule;
+  uint8_t worker_id;
+  bool raised; // false when cleared
+  float value; // Value that caused the transition (the rate per second for rate rules)
+};
+
+/**
+ * Alerts that changed in a run. Points into the engine, valid until its next run
+ */
+struct RuleAlerts {
+  const RuleAlert* alerts;
+  size_t count;
+};
+
+/**
+ * The alerts point into the engine, a copy is not valid after its next run (not recorded or snapshotted)
+ */
+template<>
+struct is_raw_copyable<RuleAlerts> : std::false_type {
+};
+
+/**
+ * Evaluates alert rules over values of workers. Rules are compiled into a table grouped per worker, and only the rules
+ * of workers that are fresh in this run are evaluated, so hundreds of rules cost nothing while their workers are idle.
+ * Produces the alerts that were raised or cleared (fresh only when any changed).
+ *
+ * Register the engine as a process worker with an id above the workers it watches to see them in the same run. Rules
+ * are evaluated on fresh values only, so a duration rule raises at the first fresh value after the duration.
+ *
+ * Rules can be changed from any task (a command handler, an async handler) while the aggregator evaluates them, the
+ * rule table is guarded by a mutex. The alerts point into the engine and are not in tick snapshots, read them in a
+ * handler on the aggregator task.
+ */
+class RuleEngine : public ProcessWorker<RuleAlerts> {
+ public:
+  /**
+   * Reads the value that rules compare from a worker
+   */
+  typedef float (*Accessor)(const BaseWorker& worker);
+
+  typedef enum Kind {
+    e_rule_none, // Removed rule, its id is reused
+    e_rule_above, // Value above threshold, clears at threshold - hysteresis or lower
+    e_rule_below, // Value below threshold, clears at threshold + hysteresis or higher
+    e_rule_rate, // Change per second (either direction) above threshold, clears at threshold - hysteresis or lower
+    e_rule_above_for, // Value above threshold for duration millis, clears like e_rule_above
+  } Kind;
+
+  static const uint16_t no_rule = 0xFFFF;
+
+  RuleEngine();
+  ~RuleEngine() override;
+
+  /**
+   * Set how to read the value of a worker, rules over workers without accessor are not evaluated
+   * @param worker_id
+   * @param accessor
+   */
+  void set_input(uint8_t worker_id, Accessor accessor);
+
+  /**
+   * Add a rule
+   * @param worker_id : worker whose value the rule checks
+   * @param kind
+   * @param threshold
+   * @param hysteresis : distance from the threshold to clear the alert
+   * @param duration : time in millis for e_rule_above_for
+   * @return rule id, no_rule if there are too many rules
+   */
+  uint16_t add_rule(uint8_t worker_id, Kind kind, float threshold, float hysteresis = 0, uint32_t duration = 0);
+
+  /**
+   * Remove a rule, an active alert is cleared without a transition
+   * @param rule
+   * @return false if the rule does not exist
+   */
+  bool remove_rule(uint16_t rule);
+
+  /**
+   * Change the threshold of a rule
+   * @param rule
+   * @param threshold
+   * @return false if the rule does not exist
+   */
+  bool set_threshold(uint16_t rule, float threshold);
+
+  /**
+   * Enable or disable a rule, disabling clears an active alert without a transition
+   * @param rule
+   * @param enabled
+   * @return false if the rule does not exist
+   */
+  bool set_rule_enabled(uint16_t rule, bool enabled);
+
+  /**
+   * Change rules with a text command, like the word argument of a command (see CommandParser):
+   *   add <worker_id> <above|below|rate|above_for> <threshold> [hysteresis] [duration]
+   *   remove <rule>
+   *   threshold <rule> <value>
+   *   enable <rule>
+   *   disable <rule>
+   * @param text : null terminated command
+   * @return rule id the command applied to, no_rule if invalid
+   */
+  uint16_t execute(const char* text);
+
+  /**
+   * Checks if the alert of a rule is raised
+   * @param rule
+   * @return
+   */
+  bool is_alerting(uint16_t rule) const;
+
+  /**
+   * Amount of rules (including removed ones), the upper bound of the rule ids
+   * @return
+   */
+  size_t get_rule_count() const;
+
+  /**
+   * Amount of times a rule was evaluated
+   * @return
+   */
+  uint32_t get_evaluations() const;
+
+ protected:
+  int8_t produce_data(const WorkerMap& workers) override;
+
+ private:
+  struct Rule {
+    uint8_t worker_id;
+    uint8_t kind;
+    bool enabled;
+    bool alerting;
+    bool has_last;
+    bool above;
+    float threshold;
+    float hysteresis;
+    uint32_t duration;
+    float last_value;
+    uint32_t last_time;
+    uint32_t above_since;
+  };
+
+  // Rules of one worker: order[first] .. order[first + count - 1]
+  struct Group {
+    uint8_t worker_id;
+    Accessor accessor;
+    uint16_t first;
+    uint16_t count;
+  };
+
+  bool valid_rule(uint16_t rule) const;
+
+  /**
+   * Rebuild the groups and order after rules or inputs changed
+   */
+  void compile();
+
+  void evaluate(uint16_t index, float value, uint32_t now);
+
+  std::vector<Rule> rules;
+  std::map<uint8_t, Accessor> inputs;
+  std::vector<Group> groups;
+  std::vector<uint16_t> order;
+  std::vector<RuleAlert> transitions;
+  SemaphoreHandle_t rules_mutex; // Guards rules, inputs and dirty
+  bool dirty;
+  uint32_t evaluations;
+};
+
+#endif //SENSOR_REPORTER_RULEENGINE_HPP_
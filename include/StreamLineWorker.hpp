@@ -0,0 +1,162 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_STREAMLINEWORKER_HPP_
+#define SENSOR_REPORTER_STREAMLINEWORKER_HPP_
+
+#include <Arduino.h>
+#include "CommandParser.hpp"
+#include "Worker.hpp"
+
+/**
+ * Collects bytes from a stream into a fixed buffer across calls, without blocking or allocating.
+ * Carriage returns and trailing spaces are stripped, lines longer than the buffer are dropped.
+ * @tparam N: maximum line length (excluding the terminator)
+ */
+template<size_t N>
+class LineReader {
+ public:
+  explicit LineReader(char delimiter = '\n') : delimiter(delimiter), length(0), overflow(false) {
+    buffer[0] = '\0';
+  }
+
+  /**
+   * Read the bytes that are available, stops after a complete line (the rest is read by the next poll)
+   * @param stream
+   * @param line : receives the null terminated line when complete (must hold N + 1 chars)
+   * @param line_length : length of the line
+   * @return true if a complete line was copied into `line`
+   */
+  bool poll(Stream& stream, char* line, size_t& line_length) {
+    // Bound the work per call, don't keep reading when bytes keep coming in
+    for (size_t budget = N + 1; budget && stream.available() > 0; --budget) {
+      int byte = stream.read();
+      if (byte < 0) {
+        break;
+      }
+      if ((char) byte == delimiter) {
+        bool complete = !overflow;
+        if (complete) {
+          while (length && (buffer[length - 1] == ' ' || buffer[length - 1] == '\r')) {
+            --length;
+          }
+          memcpy(line, buffer, length);
+          line[length] = '\0';
+          line_length = length;
+        }
+        length = 0;
+        overflow = false;
+        if (complete) {
+          return true;
+        }
+      } else if (length < N) {
+        buffer[length++] = (char) byte;
+      } else {
+        // Line too long, drop it
+        overflow = true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Checks if the line being read is too long and will be dropped
+   * @return
+   */
+  bool overflowed() const {
+    return overflow;
+  }
+
+ private:
+  char delimiter;
+  char buffer[N];
+  size_t length;
+  bool overflow;
+};
+
+/**
+ * A complete line read from a stream, the text is valid until the worker produces again
+ */
+struct StreamLine {
+  const char* text;
+  size_t length;
+};
+
+/**
+ * The text points into the worker, a copy is not valid after its next line (not recorded or snapshotted)
+ */
+template<>
+struct is_raw_copyable<StreamLine> : std::false_type {
+};
+
+/**
+ * Worker that reads lines from any stream (like Serial) without blocking. Fresh once for every complete line.
+ * @tparam N: maximum line length
+ */
+template<size_t N = 64>
+class StreamLineWorker : public Worker<StreamLine> {
+ public:
+  /**
+   * @param stream : stream to read from
+   * @param delimiter : end of line character
+   */
+  explicit StreamLineWorker(Stream& stream, char delimiter = '\n')
+      : Worker<StreamLine>(StreamLine{line, 0}, 0), stream(stream), reader(delimiter) {
+    line[0] = '\0';
+  }
+
+ protected:
+  int8_t produce_data() override {
+    size_t length;
+    if (reader.poll(stream, line, length)) {
+      data.text = line;
+      data.length = length;
+      return e_worker_data_read;
+    }
+    return e_worker_idle;
+  }
+
+ private:
+  Stream& stream;
+  LineReader<N> reader;
+  char line[N + 1];
+};
+
+/**
+ * Worker that reads commands from any stream without blocking, parsed with a table of command specs (see
+ * CommandParser). Fresh for every valid command, produces e_worker_error for lines that are not a valid command.
+ * @tparam N: maximum line length
+ */
+template<size_t N = 64>
+class StreamCommandWorker : public Worker<Command> {
+ public:
+  /**
+   * @param stream : stream to read from
+   * @param table : command specs, must outlive the worker
+   * @param size : amount of command specs
+   * @param delimiter : end of line character
+   */
+  StreamCommandWorker(Stream& stream, const CommandSpec* table, size_t size, char delimiter = '\n')
+      : Worker<Command>(Command{Command::e_command_unknown, 0, 0, 0, nullptr, 0}, 0), stream(stream),
+        reader(delimiter), parser(table, size) {
+    line[0] = '\0';
+  }
+
+ protected:
+  int8_t produce_data() override {
+    size_t length;
+    if (reader.poll(stream, line, length) && length) {
+      return parser.parse(line, data) ? e_worker_data_read : e_worker_error;
+    }
+    return e_worker_idle;
+  }
+
+ private:
+  Stream& stream;
+  LineReader<N> reader;
+  CommandParser parser;
+  char line[N + 1];
+};
+
+#endif //SENSOR_REPORTER_STREAMLINEWORKER_HPP_
@@ -0,0 +1,124 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_TICKSNAPSHOT_HPP_
+#define SENSOR_REPORTER_TICKSNAPSHOT_HPP_
+
+#include <Arduino.h>
+#include <vector>
+#include "Worker.hpp"
+
+/**
+ * Immutable copy of the state of all workers at the end of a worker stage. Used in pipelined mode (see
+ * Aggregator::enable_pipelining), where handlers run on another core while the workers already produce the next tick.
+ * Only data that can be copied as raw bytes and is self contained is copied (see is_raw_copyable). The data of other
+ * workers (like String, std::vector or RuleAlerts, which point into memory the workers reuse in the next tick) is
+ * left out, data() returns nullptr for them; the status and produce times of every worker are in the snapshot.
+ */
+class TickSnapshot {
+ public:
+  TickSnapshot();
+
+  /**
+   * Copy the current state of the workers into this snapshot (reuses its memory when the workers did not change)
+   * @param workers
+   * @param sequence : number of the tick
+   */
+  void capture(const WorkerMap& workers, uint32_t sequence);
+
+  /**
+   * Number of the tick this snapshot was taken
+   * @return
+   */
+  uint32_t get_sequence() const;
+
+  /**
+   * Checks if the snapshot contains a worker
+   * @param worker_id
+   * @return
+   */
+  bool contains(uint8_t worker_id) const;
+
+  /**
+   * Status of the worker in this tick
+   * @param worker_id
+   * @return status code (BaseWorker::Status or any custom), e_worker_idle if unknown
+   */
+  int8_t get_status(uint8_t worker_id) const;
+
+  /**
+   * Checks if the worker produced fresh data this tick
+   * @param worker_id
+   * @return
+   */
+  bool is_fresh(uint8_t worker_id) const;
+
+  /**
+   * Last produce time of the worker
+   * @param worker_id
+   * @return
+   */
+  uint32_t get_last_produce(uint8_t worker_id) const;
+
+  /**
+   * Last produce time of the worker in micros (see BaseWorker::get_produce_micros)
+   * @param worker_id
+   * @return
+   */
+  uint32_t get_produce_micros(uint8_t worker_id) const;
+
+  /**
+   * Amount of workers in the snapshot
+   * @return
+   */
+  size_t get_worker_count() const;
+
+  /**
+   * Id of a worker in the snapshot
+   * @param index : 0 up to get_worker_count
+   * @return
+   */
+  uint8_t get_worker_id(size_t index) const;
+
+  /**
+   * Checks if any of the workers produced anything this tick
+   * @return
+   */
+  bool any_updates() const;
+
+  /**
+   * Get the data of a worker
+   * @tparam T: data type of the worker
+   * @param worker_id
+   * @return pointer to the data, nullptr if unknown, not copied (see is_raw_copyable) or when the size does not match
+   */
+  template<typename T>
+  const T* data(uint8_t worker_id) const {
+    auto entry = find(worker_id);
+    if (!entry || entry->size != sizeof(T)) {
+      return nullptr;
+    }
+    return (const T*) ((const uint8_t*) storage.data() + entry->offset);
+  }
+
+ private:
+  struct Entry {
+    uint8_t id;
+    int8_t status;
+    bool fresh;
+    uint32_t last_produce;
+    uint32_t produce_micros;
+    size_t offset;
+    size_t size;
+  };
+
+  const Entry* find(uint8_t worker_id) const;
+  void layout(const WorkerMap& workers);
+
+  std::vector<Entry> entries;
+  std::vector<uint64_t> storage; // 8 byte aligned storage for the worker data
+  uint32_t sequence;
+};
+
+#endif //SENSOR_REPORTER_TICKSNAPSHOT_HPP_
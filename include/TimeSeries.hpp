@@ -0,0 +1,187 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_TIMESERIES_HPP_
+#define SENSOR_REPORTER_TIMESERIES_HPP_
+
+#include <Arduino.h>
+
+/**
+ * Writes bits most significant first into a caller provided buffer
+ */
+class BitWriter {
+ public:
+  BitWriter(uint8_t* buffer, size_t capacity);
+
+  /**
+   * Append the lowest bits of a value
+   * @param bits
+   * @param count : amount of bits (at most 32)
+   * @return false when the buffer is full (nothing is written)
+   */
+  bool write(uint32_t bits, uint8_t count);
+
+  /**
+   * Append an unsigned varint: groups of 7 bits, lowest first, with a continuation bit
+   * @param value
+   * @return false when the buffer is full (the buffer may hold part of the varint, see rewind)
+   */
+  bool write_varint(uint64_t value);
+
+  /**
+   * Drop the bits written after a position
+   * @param position : earlier result of get_position
+   */
+  void rewind(size_t position);
+
+  /**
+   * Amount of bits written
+   * @return
+   */
+  size_t get_position() const;
+
+  /**
+   * Amount of bytes used (the last one possibly partially)
+   * @return
+   */
+  size_t size() const;
+
+ private:
+  uint8_t* buffer;
+  size_t capacity;
+  size_t position;
+};
+
+/**
+ * Reads bits written by a BitWriter
+ */
+class BitReader {
+ public:
+  BitReader(const uint8_t* buffer, size_t length);
+
+  /**
+   * Read bits
+   * @param count : amount of bits (at most 32)
+   * @return the bits, 0 when reading past the end (see failed)
+   */
+  uint32_t read(uint8_t count);
+
+  /**
+   * Read an unsigned varint
+   * @return
+   */
+  uint64_t read_varint();
+
+  /**
+   * Checks if a read went past the end of the buffer or a varint was malformed
+   * @return
+   */
+  bool failed() const;
+
+ private:
+  const uint8_t* buffer;
+  size_t length;
+  size_t position;
+  bool error;
+};
+
+/**
+ * Streaming compressor for (timestamp, float) series, after Facebook's Gorilla: timestamps as delta of deltas (regular
+ * intervals take 1 bit), values XOR'ed with the previous value (unchanged values take 1 bit, slowly changing values
+ * only their changed middle bits). Values are 32 bit floats instead of Gorilla's doubles.
+ * Every append is O(1) and writes straight into the buffer, so a handler can add each fresh sample and send the buffer
+ * (with get_count) once it is full.
+ */
+class TimeSeriesEncoder {
+ public:
+  /**
+   * @param buffer : storage for the compressed series, must outlive the encoder
+   * @param capacity : size of the buffer
+   */
+  TimeSeriesEncoder(uint8_t* buffer, size_t capacity);
+
+  /**
+   * Add a sample
+   * @param timestamp : time in millis, not before the previous sample
+   * @param value
+   * @return false when the sample does not fit (the series is unchanged, send it and reset)
+   */
+  bool append(uint32_t timestamp, float value);
+
+  /**
+   * Start a new series in the same buffer
+   */
+  void reset();
+
+  /**
+   * Amount of samples in the series
+   * @return
+   */
+  uint16_t get_count() const;
+
+  /**
+   * Compressed series
+   * @return
+   */
+  const uint8_t* data() const;
+
+  /**
+   * Size of the compressed series in bytes
+   * @return
+   */
+  size_t size() const;
+
+ private:
+  bool write_timestamp(uint32_t timestamp);
+  bool write_value(uint32_t bits);
+
+  uint8_t* buffer;
+  BitWriter writer;
+  uint16_t count;
+  uint32_t previous_timestamp;
+  int32_t previous_delta;
+  uint32_t previous_value;
+  uint8_t previous_leading;
+  uint8_t previous_trailing;
+};
+
+/**
+ * Decodes a series written by a TimeSeriesEncoder
+ */
+class TimeSeriesDecoder {
+ public:
+  /**
+   * @param buffer : compressed series
+   * @param length : size of the compressed series
+   * @param count : amount of samples in the series (see TimeSeriesEncoder::get_count)
+   */
+  TimeSeriesDecoder(const uint8_t* buffer, size_t length, uint16_t count);
+
+  /**
+   * Decode the next sample
+   * @param timestamp
+   * @param value
+   * @return false when all samples are decoded or the series is corrupt (see failed)
+   */
+  bool next(uint32_t& timestamp, float& value);
+
+  /**
+   * Checks if the series was truncated or corrupt
+   * @return
+   */
+  bool failed() const;
+
+ private:
+  BitReader reader;
+  uint16_t remaining;
+  uint16_t decoded;
+  uint32_t previous_timestamp;
+  int32_t previous_delta;
+  uint32_t previous_value;
+  uint8_t previous_leading;
+  uint8_t previous_trailing;
+  bool corrupt;
+};
+
+#endif //SENSOR_REPORTER_TIMESERIES_HPP_
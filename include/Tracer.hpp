@@ -0,0 +1,123 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_TRACER_HPP_
+#define SENSOR_REPORTER_TRACER_HPP_
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * Amount of events kept in the trace ring buffer, older events are overwritten
+ */
+#ifndef SENSOR_REPORTER_TRACE_CAPACITY
+#define SENSOR_REPORTER_TRACE_CAPACITY 512
+#endif
+
+// The event count is a u16 in the dump header
+static_assert(SENSOR_REPORTER_TRACE_CAPACITY > 0 && SENSOR_REPORTER_TRACE_CAPACITY <= 65535,
+              "SENSOR_REPORTER_TRACE_CAPACITY must be 1..65535");
+
+/**
+ * Low overhead event tracer. Records begin/end events of the framework stages in a fixed ring buffer, which can be
+ * dumped in a compact binary form (see tools/trace_to_chrome.py to convert it to a Chrome/Perfetto trace).
+ * Only compiled into the framework when building with -DSENSOR_REPORTER_TRACE
+ */
+class Tracer {
+ public:
+  typedef enum Component {
+    e_trace_aggregator = 0,
+    e_trace_worker,
+    e_trace_handler,
+    e_trace_supervisor,
+  } Component;
+
+  typedef enum Stage {
+    e_trace_tick = 0, // Full Aggregator::run
+    e_trace_work, // BaseWorker::work
+    e_trace_handle, // Handler::try_handle_work
+    e_trace_task, // Async task (run_task)
+    e_trace_finish, // BaseWorker::finish_produced_data
+    e_trace_report, // Supervisor::handle_report
+  } Stage;
+
+  typedef enum Phase {
+    e_trace_begin = 0,
+    e_trace_end,
+  } Phase;
+
+  /**
+   * A single trace event, 8 bytes
+   */
+  struct Event {
+    uint32_t timestamp; // micros
+    uint8_t phase_core; // bit 7: phase, bits 0-6: core
+    uint8_t component;
+    uint8_t stage;
+    uint8_t id;
+  };
+
+  /**
+   * Record an event in the ring buffer, safe to call from any task or core
+   * @param phase: begin or end
+   * @param component: type of the component
+   * @param stage: stage of the framework
+   * @param id: id of the component (worker/handler id or supervisor index)
+   */
+  static void record(Phase phase, Component component, Stage stage, uint8_t id);
+
+  /**
+   * Enable / disable recording (enabled by default)
+   */
+  static void set_enabled(bool enabled);
+
+  /**
+   * Clear the recorded events
+   */
+  static void clear();
+
+  /**
+   * Write all recorded events (oldest first) in binary form. Recording is paused while dumping, events that are being
+   * written when the dump starts are finished first.
+   * Format (little endian): "SRTR", u8 version, u8 event size, u16 event count, u32 overwritten events, events...
+   * @param out: output to write to (like Serial)
+   */
+  static void dump(Print& out);
+
+ private:
+  static Event events[SENSOR_REPORTER_TRACE_CAPACITY];
+  static std::atomic<uint32_t> head;
+  static std::atomic<bool> enabled;
+  static std::atomic<uint32_t> writers; // Calls of record in progress
+};
+
+/**
+ * Records a begin event on construction and an end event on destruction
+ */
+class TraceScope {
+ public:
+  TraceScope(Tracer::Component component, Tracer::Stage stage, uint8_t id)
+      : component(component), stage(stage), id(id) {
+    Tracer::record(Tracer::e_trace_begin, component, stage, id);
+  }
+
+  ~TraceScope() {
+    Tracer::record(Tracer::e_trace_end, component, stage, id);
+  }
+
+ private:
+  Tracer::Component component;
+  Tracer::Stage stage;
+  uint8_t id;
+};
+
+#ifdef SENSOR_REPORTER_TRACE
+#define SR_TRACE_CONCAT_(a, b) a##b
+#define SR_TRACE_CONCAT(a, b) SR_TRACE_CONCAT_(a, b)
+#define SR_TRACE_SCOPE(component, stage, id) TraceScope SR_TRACE_CONCAT(_trace_scope_, __LINE__)(component, stage, id)
+#else
+#define SR_TRACE_SCOPE(component, stage, id) do {} while (0)
+#endif
+
+#endif //SENSOR_REPORTER_TRACER_HPP_
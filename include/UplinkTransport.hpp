@@ -0,0 +1,135 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_UPLINKTRANSPORT_HPP_
+#define SENSOR_REPORTER_UPLINKTRANSPORT_HPP_
+
+#include <Arduino.h>
+#include <Client.h>
+#include <vector>
+
+/**
+ * Byte stream connection used by uplink handlers. Implement this to run an uplink over anything else than an Arduino
+ * Client, like a socket on the host to test against a local server.
+ */
+class UplinkTransport {
+ public:
+  virtual ~UplinkTransport() = default;
+
+  /**
+   * Open the connection
+   * @return true if connected
+   */
+  virtual bool connect() = 0;
+
+  /**
+   * Checks if the connection is (still) open
+   * @return
+   */
+  virtual bool connected() = 0;
+
+  /**
+   * Write bytes
+   * @return amount of bytes written, less than length on failure
+   */
+  virtual size_t write(const uint8_t* buffer, size_t length) = 0;
+
+  /**
+   * Amount of bytes that can be read without blocking
+   * @return
+   */
+  virtual int available() = 0;
+
+  /**
+   * Read bytes that are available
+   * @return amount of bytes read
+   */
+  virtual size_t read(uint8_t* buffer, size_t length) = 0;
+
+  /**
+   * Close the connection
+   */
+  virtual void close() = 0;
+};
+
+/**
+ * Transport over an Arduino Client (like WiFiClient or WiFiClientSecure)
+ */
+class ClientTransport : public UplinkTransport {
+ public:
+  /**
+   * @param client : client to use, must outlive the transport
+   * @param host : host to connect to
+   * @param port : port to connect to
+   */
+  ClientTransport(Client& client, const char* host, uint16_t port);
+
+  bool connect() override;
+  bool connected() override;
+  size_t write(const uint8_t* buffer, size_t length) override;
+  int available() override;
+  size_t read(uint8_t* buffer, size_t length) override;
+  void close() override;
+
+ private:
+  Client& client;
+  const char* host;
+  uint16_t port;
+};
+
+/**
+ * In memory transport, to run an uplink without network (like on the host). Keeps what is written, serves the bytes
+ * given to respond() as incoming data. The connection can be refused or dropped to test reconnecting.
+ */
+class LoopbackTransport : public UplinkTransport {
+ public:
+  LoopbackTransport();
+
+  bool connect() override;
+  bool connected() override;
+  size_t write(const uint8_t* buffer, size_t length) override;
+  int available() override;
+  size_t read(uint8_t* buffer, size_t length) override;
+  void close() override;
+
+  /**
+   * Add incoming bytes, like a response of the server
+   * @param data : null terminated
+   */
+  void respond(const char* data);
+
+  /**
+   * Make connect() succeed or fail
+   * @param reachable
+   */
+  void set_reachable(bool reachable);
+
+  /**
+   * Lose the connection, incoming bytes that were not read are lost
+   */
+  void drop();
+
+  /**
+   * Get everything written since the last clear_written
+   * @return
+   */
+  const std::vector<uint8_t>& get_written() const;
+  void clear_written();
+
+  /**
+   * Amount of successful connects
+   * @return
+   */
+  uint32_t get_connects() const;
+
+ private:
+  std::vector<uint8_t> written;
+  std::vector<uint8_t> incoming;
+  size_t read_position;
+  bool reachable;
+  bool open;
+  uint32_t connects;
+};
+
+#endif //SENSOR_REPORTER_UPLINKTRANSPORT_HPP_
@@ -7,7 +7,10 @@
 
 #include <Arduino.h>
 #include <map>
+#include <type_traits>
 #include "Activatable.hpp"
+#include "CorePlacement.hpp"
+#include "EncodingCache.hpp"
 
 class Aggregator;
 class WorkerMap;
@@ -18,6 +21,15 @@ class Worker;
 
 typedef WorkerMap worker_map_t;
 
+/**
+ * Whether worker data of type T can be copied as raw bytes (recorded, replayed, snapshotted for the pipeline). True
+ * for trivially copyable types, specialize it as false for trivially copyable types that point into memory that is
+ * reused, like RuleAlerts.
+ */
+template<typename T>
+struct is_raw_copyable : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {
+};
+
 /**
  * Base class for the worker
  * To use this, extend the Worker class
@@ -38,6 +50,24 @@ class BaseWorker : public Activatable {
     e_worker_error,
   } Status;
 
+  /**
+   * How the worker decides when to produce
+   */
+  typedef enum Schedule {
+    e_schedule_break, // After break_duration since the last produce (default)
+    e_schedule_aligned, // On slots phase + k * period, rounded up to the aggregator sampling grid
+    e_schedule_fixed_rate, // Every period exactly, the next due time advances by the period (no drift)
+  } Schedule;
+
+  /**
+   * What a fixed rate worker does when it is a full period (or more) late, like after a slow run
+   */
+  typedef enum CatchUp {
+    e_catch_up_skip, // Skip the missed slots, produce again on the next slot
+    e_catch_up_burst, // Produce every run until caught up, every slot gets a produce
+    e_catch_up_coalesce, // Produce once for all missed slots, continue on the next slot
+  } CatchUp;
+
   explicit BaseWorker(uint32_t break_duration = 0);
   virtual ~BaseWorker() = default;
 
@@ -56,12 +86,82 @@ class BaseWorker : public Activatable {
    */
   uint32_t get_last_produce() const;
 
+  /**
+   * Time of the last fresh output in micros, the tag used to measure how old the data is when it is handled
+   * @return
+   */
+  uint32_t get_produce_micros() const;
+
   /**
    * Checks if fresh data is read
    * @return
    */
   bool is_fresh() const;
 
+  /**
+   * Get the id this worker is registered with in the aggregator
+   * @return
+   */
+  uint8_t get_id() const;
+
+  /**
+   * Amount of times this worker produced fresh data
+   * @return
+   */
+  uint32_t get_produce_count() const;
+
+  /**
+   * Produce on fixed slots (phase + k * period) instead of after a break since the last produce. Workers with related
+   * periods (like 1000 and 2000) become fresh in the same run, so handlers are called once for both.
+   * @param period : time between slots in millis
+   * @param phase : offset of the slots in millis
+   */
+  void set_aligned_schedule(uint32_t period, uint32_t phase = 0);
+
+  /**
+   * Produce at a fixed rate: the next due time advances by exactly the period (instead of a break after the produce,
+   * which adds the run latency and produce time every period)
+   * @param period : time between produces in millis
+   * @param catch_up : what to do when a period or more behind
+   */
+  void set_fixed_rate_schedule(uint32_t period, CatchUp catch_up = e_catch_up_skip);
+
+  /**
+   * Get the schedule of the worker
+   * @return
+   */
+  Schedule get_schedule() const;
+
+  /**
+   * Slots of a fixed rate worker that were not produced (skipped or coalesced)
+   * @return
+   */
+  uint32_t get_missed_slots() const;
+
+  /**
+   * Slots of a fixed rate worker that were produced a period or more late
+   * @return
+   */
+  uint32_t get_late_slots() const;
+
+  /**
+   * Time the worker is due to produce next
+   * @return time in millis
+   */
+  uint32_t get_next_due() const;
+
+  /**
+   * Raw bytes of the produced data, used to record / snapshot work (see is_raw_copyable)
+   * @return pointer to the data, nullptr if the worker has no data or its data can't be copied as raw bytes
+   */
+  virtual const void* get_raw_data() const;
+
+  /**
+   * Size of the raw data
+   * @return size in bytes
+   */
+  virtual size_t get_data_size() const;
+
  protected:
   /**
    * The main function to implement in sub classes, store produced work in `data` property
@@ -92,11 +192,27 @@ class BaseWorker : public Activatable {
 
   virtual bool is_process_worker() const = 0;
 
-  int8_t start_task(const char* task_name, uint32_t memory=1024, uint8_t priority=5, uint8_t core=0);
+  /**
+   * Start a task running produce_async_data
+   * @param task_name
+   * @param memory : stack size
+   * @param priority
+   * @param core : core to pin the task to, by default the least loaded core (see CorePlacement)
+   * @return e_worker_processing
+   */
+  int8_t start_task(const char* task_name, uint32_t memory=1024, uint8_t priority=5,
+                    uint8_t core=CorePlacement::core_auto);
   void kill_task();
 
   virtual bool task_running() const;
 
+  /**
+   * Continue async work that runs on the aggregator task instead of in its own task (see CoWorker). Called every run
+   * while the worker is processing and no task is running
+   * @return status code, e_worker_processing while the work is not finished
+   */
+  virtual int8_t resume_async();
+
  private:
 
   /**
@@ -105,8 +221,41 @@ class BaseWorker : public Activatable {
    */
   bool work(const worker_map_t& workers);
 
+  /**
+   * Checks if the worker should produce now
+   */
+  bool is_due(uint32_t now);
+
+  /**
+   * Checks if work() would do anything now (due, resuming async work or retrying activation), without changing the
+   * schedule
+   */
+  bool wants_to_run(uint32_t now) const;
+
+  /**
+   * Start of the current break (break schedule): the last produce, or the last produce the circuit breaker rejected
+   */
+  uint32_t last_break_start() const;
+
+  /**
+   * First aligned slot after now
+   */
+  uint32_t next_aligned_slot(uint32_t now) const;
+
+  uint8_t id;
   uint32_t break_duration;
+  Schedule schedule;
+  CatchUp catch_up;
+  uint32_t missed_slots;
+  uint32_t late_slots;
+  uint32_t phase;
+  uint32_t grid;
+  uint32_t next_due;
+  bool schedule_started;
   uint32_t last_produce;
+  uint32_t last_rejected; // Last time the circuit breaker rejected a due produce, 0 if the last one was allowed
+  uint32_t produce_micros;
+  uint32_t produce_count;
   int8_t status;
   int8_t async_result_status;
 
@@ -115,6 +264,8 @@ class BaseWorker : public Activatable {
   static void run_task(void* instance);
 
   TaskHandle_t xAsyncWorkerHandle;
+  uint8_t task_core;
+  uint32_t task_started;
 
   friend Aggregator;
 };
@@ -131,7 +282,7 @@ class Worker : public BaseWorker {
    *
    * Construct a worker, calls default constructor for data
    * @param worker_id : unique id of the worker
-   * @param break_duration : time in millis how long the delay should be between produced work, default 0.
+   * @param break_duration : time in millis how long the delay should be between produced work, default 0 (every run).
    */
   explicit Worker(uint32_t break_duration = 0)
       : BaseWorker(break_duration), data() {
@@ -141,7 +292,7 @@ class Worker : public BaseWorker {
    * Construct a worker with initial data T
    * @param worker_id : unique id of the worker
    * @param initial_val : initial value of the data it produces
-   * @param break_duration : time in millis how long the delay should be between produced work, default 0.
+   * @param break_duration : time in millis how long the delay should be between produced work, default 0 (every run).
    */
   explicit Worker(T initial_val, uint32_t break_duration = 0)
       : BaseWorker(break_duration), data(initial_val) {
@@ -154,10 +305,18 @@ class Worker : public BaseWorker {
    * Get the current data from the worker
    * @return current data
    */
-  const T& get_data() {
+  const T& get_data() const {
     return data;
   }
 
+  const void* get_raw_data() const override {
+    return is_raw_copyable<T>::value ? &data : nullptr;
+  }
+
+  size_t get_data_size() const override {
+    return is_raw_copyable<T>::value ? sizeof(T) : 0;
+  }
+
  protected:
   bool is_process_worker() const override {
     return false;
@@ -185,7 +344,7 @@ class ProcessWorker : public Worker<T> {
    *
    * Construct a worker, calls default constructor for data
    * @param worker_id : unique id of the worker
-   * @param break_duration : time in millis how long the delay should be between produced work, default 0.
+   * @param break_duration : time in millis how long the delay should be between produced work, default 0 (every run).
    */
   explicit ProcessWorker(uint32_t break_duration = 0)
       : Worker<T>(break_duration) {
@@ -195,7 +354,7 @@ class ProcessWorker : public Worker<T> {
    * Construct a worker with initial data T
    * @param worker_id : unique id of the worker
    * @param initial_val : initial value of the data it produces
-   * @param break_duration : time in millis how long the delay should be between produced work, default 0.
+   * @param break_duration : time in millis how long the delay should be between produced work, default 0 (every run).
    */
   explicit ProcessWorker(T initial_val, uint32_t break_duration = 0)
       : Worker<T>(initial_val, break_duration) {
@@ -221,6 +380,7 @@ class ProcessWorker : public Worker<T> {
 
 class WorkerMap : public std::map<uint8_t, BaseWorker*> {
  public:
+  WorkerMap() : encoding_cache(nullptr) {}
 
   template<typename T, typename std::enable_if<std::is_base_of<BaseWorker, T>::value>::type* = nullptr>
   T* worker(uint8_t idx) const {
@@ -228,6 +388,22 @@ class WorkerMap : public std::map<uint8_t, BaseWorker*> {
   }
 
   bool any_updates() const;
+
+  /**
+   * Get the data of a worker encoded in some format, shared by all handlers/supervisors in this run so the data is
+   * only encoded once. Do not use the result from an async task, copy it first. See EncodingCache
+   * @param worker_id
+   * @param format : custom format id, the same format must always use the same encoder
+   * @param encoder : function to encode the data
+   * @param length : receives the length of the encoded data
+   * @return pointer to the encoded data, nullptr if encoding failed (or no cache is set and it was not encoded)
+   */
+  const uint8_t* encode(uint8_t worker_id, uint8_t format, EncodingCache::Encoder encoder, size_t& length) const;
+
+ private:
+  EncodingCache* encoding_cache;
+
+  friend Aggregator;
 };
 
 #endif //SENSOR_REPORTER_SENSOR_HPP_
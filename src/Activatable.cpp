@@ -3,8 +3,9 @@
 //
 
 #include <Activatable.hpp>
+#include "Clock.hpp"
 
-Activatable::Activatable(): active_state(e_state_inactive) {
+Activatable::Activatable(): active_state(e_state_inactive), priority(e_priority_normal), deferred(false) {
 
 }
 
@@ -36,3 +37,33 @@ bool Activatable::active() const {
 Activatable::State Activatable::get_active_state() const {
   return active_state;
 }
+
+void Activatable::set_priority(Priority _priority) {
+  priority = _priority;
+}
+
+Activatable::Priority Activatable::get_priority() const {
+  return priority;
+}
+
+void Activatable::set_circuit_breaker(uint8_t threshold, uint8_t window, uint32_t open_millis) {
+  circuit_breaker.configure(threshold, window, open_millis);
+}
+
+const CircuitBreaker& Activatable::get_circuit_breaker() const {
+  return circuit_breaker;
+}
+
+bool Activatable::breaker_allows() {
+  return circuit_breaker.allow(Clock::get().millis());
+}
+
+void Activatable::record_outcome(int8_t status) {
+  // Negative statuses (idle, processing) are no outcome, 0 is success and anything above is an error
+  if (status >= 0) {
+    circuit_breaker.record(status == 0, Clock::get().millis());
+  } else if (status == -1) {
+    // Idle, a probe call without outcome: probe again on the next call. Processing records its outcome later
+    circuit_breaker.cancel_probe();
+  }
+}
@@ -3,14 +3,62 @@
 //
 
 #include <Aggregator.hpp>
+#include <Tracer.hpp>
+#include <Clock.hpp>
 
-Aggregator::Aggregator() = default;
+static const uint8_t pipeline_stop_slot = 0xFF;
+
+/**
+ * Holds a recursive mutex for the lifetime of the lock
+ */
+class RecursiveLock {
+ public:
+  explicit RecursiveLock(SemaphoreHandle_t mutex) : mutex(mutex) {
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+  }
+
+  ~RecursiveLock() {
+    xSemaphoreGiveRecursive(mutex);
+  }
+
+ private:
+  SemaphoreHandle_t mutex;
+};
+
+Aggregator::Aggregator()
+    : sampling_grid(1), tick_budget(0), tick_start(0), tick_stats(), pipeline_free(nullptr), pipeline_filled(nullptr),
+      pipeline_done(nullptr), pipeline_task(nullptr), pipeline_poll(10), pipeline_sequence(0), pipeline_stats(),
+      workers_mutex(xSemaphoreCreateRecursiveMutex()), handlers_mutex(xSemaphoreCreateRecursiveMutex()),
+      deferred_initialization(false), boot_signal(nullptr), boot_tasks(0), boot_duration(0), aggregator_task(nullptr), aggregator_done(nullptr), run_period(0), stop_requested(false) {
+  workers.encoding_cache = &encoding_cache;
+}
+
+Aggregator::~Aggregator() {
+  stop();
+  disable_pipelining();
+  // Tasks of a timed out boot still write their item and give the signal
+  while(boot_tasks) {
+    vTaskDelay(1);
+  }
+  vSemaphoreDelete(workers_mutex);
+  vSemaphoreDelete(handlers_mutex);
+  if(boot_signal) {
+    vSemaphoreDelete(boot_signal);
+  }
+}
 
 void Aggregator::register_worker(uint8_t worker_id, BaseWorker& worker) {
+  RecursiveLock lock(workers_mutex);
   if(workers.find(worker_id) == workers.end()) {
     // Create new worker and measurement
     workers[worker_id] = &worker;
-    worker.initialize();
+    worker.id = worker_id;
+    worker.grid = sampling_grid;
+    if(deferred_initialization) {
+      uninitialized.push_back(&worker);
+    } else {
+      worker.initialize();
+    }
   } else {
     // Receiver with this id already exists...
     // TODO: add error logging
@@ -18,10 +66,16 @@ void Aggregator::register_worker(uint8_t worker_id, BaseWorker& worker) {
 }
 
 void Aggregator::register_handler(uint8_t handler_id, Handler& handler) {
+  RecursiveLock lock(handlers_mutex);
   if(handlers.find(handler_id) == handlers.end()) {
     // Create new handler
     handlers[handler_id] = &handler;
-    handler.initialize();
+    handler.id = handler_id;
+    if(deferred_initialization) {
+      uninitialized.push_back(&handler);
+    } else {
+      handler.initialize();
+    }
   } else {
     // Observer with this id already exists...
     // TODO: add error logging
@@ -34,41 +88,514 @@ void Aggregator::register_supervisor(Supervisor& supervisor) {
 }
 
 void Aggregator::run() {
-  bool any_new = false;
+  SR_TRACE_SCOPE(Tracer::e_trace_aggregator, Tracer::e_trace_tick, 0);
+  tick_start = Clock::get().micros();
+  encoding_cache.clear();
   // Workers produce data
-  for(const auto& w : workers) {
-    auto& worker = w.second;
-    if(worker && !worker->is_process_worker() && worker->work(workers)) {
-      any_new = true;
-    }
-  }
-  for(const auto& w : workers) {
-    // Process workers produce data using the workers
-    auto& worker = w.second;
-    if(worker && worker->is_process_worker() && worker->work(workers)) {
-      any_new = true;
-    }
+  bool any_new = run_workers();
+  if(pipeline_task && any_new) {
+    // Handlers supporting snapshots handle the produced work on the pipeline task
+    hand_off_snapshot();
   }
   // Handlers handle produced work
-  for(const auto& r : handlers) {
-    auto handler = r.second;
-    if(handler && (any_new || handler->get_status() == Handler::e_handler_processing)) {
-      handler->try_handle_work(workers);
-    }
-  }
+  run_handlers(any_new);
   // Submit final report
+  uint8_t supervisor_idx = 0;
   for(const auto& report_handler : supervisors) {
     if(report_handler) {
+      SR_TRACE_SCOPE(Tracer::e_trace_supervisor, Tracer::e_trace_report, supervisor_idx);
       report_handler->handle_report(workers, handlers);
     }
+    ++supervisor_idx;
+  }
+
+  uint32_t duration = Clock::get().micros() - tick_start;
+  ++tick_stats.ticks;
+  tick_stats.last_tick_micros = duration;
+  if(duration > tick_stats.max_tick_micros) {
+    tick_stats.max_tick_micros = duration;
+  }
+  if(tick_budget && duration > tick_budget) {
+    ++tick_stats.overrun_ticks;
+  }
+}
+
+bool Aggregator::run_workers() {
+  RecursiveLock lock(workers_mutex);
+  bool any_new = false;
+  // Normal workers first, process workers produce data using the workers afterwards. Each by priority class
+  for(uint8_t process = 0; process < 2; ++process) {
+    for(uint8_t priority = 0; priority < Activatable::e_priority_count; ++priority) {
+      for(const auto& w : workers) {
+        auto& worker = w.second;
+        if(!worker || worker->is_process_worker() != (bool) process || worker->get_priority() != priority) {
+          continue;
+        }
+        if(tick_budget && !worker->wants_to_run(Clock::get().millis())) {
+          // Not due: nothing to defer, work() only marks it idle
+          worker->work(workers);
+          continue;
+        }
+        // A process worker deferred past fresh sources would miss their data for good
+        if(process && any_new) {
+          worker->deferred = false;
+        } else if(!within_budget(*worker, tick_stats.deferrals)) {
+          if(worker->status != BaseWorker::e_worker_processing) {
+            // Don't leave the data of the previous run fresh
+            worker->status = BaseWorker::e_worker_idle;
+          }
+          continue;
+        }
+        uint32_t started = Clock::get().micros();
+        if(worker->work(workers)) {
+          any_new = true;
+        }
+        account_budget(*worker, started);
+      }
+    }
+  }
+  return any_new;
+}
+
+void Aggregator::run_handlers(bool any_new) {
+  RecursiveLock lock(handlers_mutex);
+  for(uint8_t priority = 0; priority < Activatable::e_priority_count; ++priority) {
+    for(const auto& r : handlers) {
+      auto handler = r.second;
+      if(!handler || handler->get_priority() != priority || (pipeline_task && handler->handles_snapshots())) {
+        continue;
+      }
+      if(any_new || handler->get_status() == Handler::e_handler_processing || handler->handles_every_run()) {
+        if(!within_budget(*handler, tick_stats.shed)) {
+          if(handler->status != Handler::e_handler_processing) {
+            handler->status = Handler::e_handler_idle;
+          }
+          continue;
+        }
+        uint32_t started = Clock::get().micros();
+        handler->try_handle_work(workers);
+        account_budget(*handler, started);
+      }
+    }
+  }
+}
+
+bool Aggregator::within_budget(Activatable& component, uint32_t* counters) {
+  if(!tick_budget || component.priority == Activatable::e_priority_high || component.deferred) {
+    component.deferred = false;
+    return true;
+  }
+  if(Clock::get().micros() - tick_start < tick_budget) {
+    return true;
+  }
+  component.deferred = true;
+  ++counters[component.priority];
+  return false;
+}
+
+void Aggregator::account_budget(const Activatable& component, uint32_t started) {
+  if(tick_budget && Clock::get().micros() - tick_start > tick_budget && started - tick_start <= tick_budget) {
+    ++tick_stats.overruns[component.priority];
   }
+}
+
+void Aggregator::set_tick_budget(uint32_t budget_micros) {
+  tick_budget = budget_micros;
+}
+
+const Aggregator::TickStats& Aggregator::get_tick_stats() const {
+  return tick_stats;
+}
 
+void Aggregator::reset_tick_stats() {
+  tick_stats = TickStats();
 }
 
 void Aggregator::set_worker_active(uint8_t worker_id, bool active) {
+  RecursiveLock lock(workers_mutex);
   workers.at(worker_id)->set_active(active);
 }
 
 void Aggregator::set_handler_active(uint8_t handler_id, bool active) {
+  RecursiveLock lock(handlers_mutex);
   handlers.at(handler_id)->set_active(active);
 }
+
+bool Aggregator::enable_pipelining(uint8_t depth, uint8_t core, uint8_t priority, uint32_t memory, uint32_t poll_millis) {
+  if(pipeline_task || depth == 0 || depth >= pipeline_stop_slot) {
+    return false;
+  }
+  snapshots.assign(depth, TickSnapshot());
+  pipeline_free = xQueueCreate(depth, sizeof(uint8_t));
+  pipeline_filled = xQueueCreate(depth + 1, sizeof(uint8_t));
+  pipeline_done = xSemaphoreCreateBinary();
+  pipeline_poll = poll_millis;
+  for(uint8_t slot = 0; slot < depth; ++slot) {
+    xQueueSend(pipeline_free, &slot, 0);
+  }
+  if(xTaskCreatePinnedToCore(Aggregator::run_pipeline, "pipeline", memory, this, priority, &pipeline_task, core) != pdPASS) {
+    pipeline_task = nullptr;
+    disable_pipelining();
+    return false;
+  }
+  return true;
+}
+
+void Aggregator::disable_pipelining() {
+  if(pipeline_task) {
+    xQueueSend(pipeline_filled, &pipeline_stop_slot, portMAX_DELAY);
+    xSemaphoreTake(pipeline_done, portMAX_DELAY);
+    pipeline_task = nullptr;
+  }
+  if(pipeline_free) {
+    vQueueDelete(pipeline_free);
+    pipeline_free = nullptr;
+  }
+  if(pipeline_filled) {
+    vQueueDelete(pipeline_filled);
+    pipeline_filled = nullptr;
+  }
+  if(pipeline_done) {
+    vSemaphoreDelete(pipeline_done);
+    pipeline_done = nullptr;
+  }
+  snapshots.clear();
+}
+
+const Aggregator::PipelineStats& Aggregator::get_pipeline_stats() const {
+  return pipeline_stats;
+}
+
+void Aggregator::hand_off_snapshot() {
+  uint8_t slot;
+  if(xQueueReceive(pipeline_free, &slot, 0) != pdTRUE) {
+    // All snapshots in flight, wait for the handler stage
+    ++pipeline_stats.stalls;
+    xQueueReceive(pipeline_free, &slot, portMAX_DELAY);
+  }
+  {
+    RecursiveLock lock(workers_mutex);
+    snapshots[slot].capture(workers, ++pipeline_sequence);
+  }
+  ++pipeline_stats.snapshots;
+  xQueueSend(pipeline_filled, &slot, portMAX_DELAY);
+}
+
+void Aggregator::run_pipeline(void* instance) {
+  auto aggregator = (Aggregator*) instance;
+  for(;;) {
+    uint8_t slot;
+    bool received = xQueueReceive(aggregator->pipeline_filled, &slot, pdMS_TO_TICKS(aggregator->pipeline_poll)) == pdTRUE;
+    if(received && slot == pipeline_stop_slot) {
+      break;
+    }
+    const TickSnapshot* snapshot = received ? &aggregator->snapshots[slot] : nullptr;
+    // The handlers are registered before pipelining starts. Lock per call (against activation changes), not for the
+    // whole stage, so the handlers in run() don't wait for the snapshot handlers
+    for(uint8_t priority = 0; priority < Activatable::e_priority_count; ++priority) {
+      for(const auto& r : aggregator->handlers) {
+        auto handler = r.second;
+        if(handler && handler->get_priority() == priority && handler->handles_snapshots()) {
+          RecursiveLock lock(aggregator->handlers_mutex);
+          if(snapshot || handler->get_status() == Handler::e_handler_processing) {
+            handler->try_handle_snapshot(snapshot);
+          }
+        }
+      }
+    }
+    if(received) {
+      // Snapshot handled, can be reused by the worker stage
+      xQueueSend(aggregator->pipeline_free, &slot, portMAX_DELAY);
+    }
+  }
+  xSemaphoreGive(aggregator->pipeline_done);
+  vTaskDelete(nullptr);
+}
+
+bool Aggregator::start(uint32_t period_millis, uint8_t priority, uint8_t core, uint32_t memory) {
+  if(aggregator_task) {
+    if(!stop_requested || xTaskGetCurrentTaskHandle() == aggregator_task) {
+      return false; // Already running
+    }
+    // Stopped from its own task, clean up the finished task first
+    stop();
+  }
+  run_period = period_millis;
+  stop_requested = false;
+  aggregator_done = xSemaphoreCreateBinary();
+  if(xTaskCreatePinnedToCore(Aggregator::run_task, "aggregator", memory, this, priority, &aggregator_task, core) != pdPASS) {
+    aggregator_task = nullptr;
+    vSemaphoreDelete(aggregator_done);
+    aggregator_done = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void Aggregator::stop() {
+  if(!aggregator_task) {
+    return;
+  }
+  stop_requested = true;
+  if(xTaskGetCurrentTaskHandle() == aggregator_task) {
+    // Called from a worker/handler/supervisor, the task stops after this run. The next stop() or start() (or the
+    // destructor) collects it
+    return;
+  }
+  // The task always signals when it ends, also after it was stopped from itself
+  xSemaphoreTake(aggregator_done, portMAX_DELAY);
+  vSemaphoreDelete(aggregator_done);
+  aggregator_done = nullptr;
+  aggregator_task = nullptr;
+}
+
+EncodingCache& Aggregator::get_encoding_cache() {
+  return encoding_cache;
+}
+
+bool Aggregator::running() const {
+  return aggregator_task != nullptr && !stop_requested;
+}
+
+void Aggregator::run_task(void* instance) {
+  auto aggregator = (Aggregator*) instance;
+  TickType_t last_wake = xTaskGetTickCount();
+  while(!aggregator->stop_requested) {
+    aggregator->run();
+    if(aggregator->run_period) {
+      vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(aggregator->run_period));
+    } else {
+      // Let lower priority tasks (and the idle task / watchdog) run
+      vTaskDelay(1);
+    }
+  }
+  xSemaphoreGive(aggregator->aggregator_done);
+  vTaskDelete(nullptr);
+}
+
+void Aggregator::set_deferred_initialization(bool deferred) {
+  deferred_initialization = deferred;
+}
+
+uint16_t Aggregator::boot_key(ComponentKind kind, uint8_t id) {
+  return (uint16_t) ((kind << 8) | id);
+}
+
+void Aggregator::add_boot_dependency(ComponentKind kind, uint8_t id, ComponentKind dependency_kind,
+                                     uint8_t dependency_id) {
+  boot_options[boot_key(kind, id)].dependencies.push_back(boot_key(dependency_kind, dependency_id));
+}
+
+void Aggregator::set_boot_timeout(ComponentKind kind, uint8_t id, uint32_t timeout_millis) {
+  boot_options[boot_key(kind, id)].timeout = timeout_millis;
+}
+
+Aggregator::BootState Aggregator::get_boot_state(ComponentKind kind, uint8_t id) const {
+  uint16_t key = boot_key(kind, id);
+  for(const auto& item : boot_items) {
+    if(item.key == key) {
+      return item.state == e_boot_running && item.timed_out ? e_boot_timeout : item.state;
+    }
+  }
+  return e_boot_pending;
+}
+
+uint32_t Aggregator::get_boot_duration() const {
+  return boot_duration;
+}
+
+bool Aggregator::boot_dependencies_done(const BootItem& item, bool& failed) {
+  failed = false;
+  auto options = boot_options.find(item.key);
+  if(options == boot_options.end()) {
+    return true;
+  }
+  bool done = true;
+  for(auto dependency : options->second.dependencies) {
+    auto other = std::find_if(
+        boot_items.begin(),
+        boot_items.end(),
+        [dependency](const BootItem& other) { return other.key == dependency; }
+    );
+    if(other == boot_items.end()) {
+      // Not booting: fine when it is up already
+      failed = !component_active(dependency);
+    } else if(other->state == e_boot_failed || (other->state == e_boot_running && other->timed_out)) {
+      failed = true;
+    } else if(other->state != e_boot_done) {
+      done = false;
+    }
+    if(failed) {
+      return false;
+    }
+  }
+  return done;
+}
+
+bool Aggregator::boot(uint32_t timeout_millis, uint8_t priority, uint32_t memory) {
+  for(const auto& item : boot_items) {
+    if(item.state == e_boot_running) {
+      // Tasks of a previous boot (timed out) still use the items
+      return false;
+    }
+  }
+  uint32_t boot_start = Clock::get().millis();
+
+  boot_items.clear();
+  {
+    // Only locked while collecting, the components may use the aggregator while they boot
+    RecursiveLock workers_lock(workers_mutex);
+    RecursiveLock handlers_lock(handlers_mutex);
+    auto add_item = [&](Activatable* component, uint16_t key) {
+      bool initialize = std::find(uninitialized.begin(), uninitialized.end(), component) != uninitialized.end();
+      if(!component || (component->active() && !initialize)) {
+        return;
+      }
+      auto options = boot_options.find(key);
+      uint32_t timeout = options != boot_options.end() && options->second.timeout ? options->second.timeout : timeout_millis;
+      boot_items.push_back(BootItem{component, key, initialize, e_boot_pending, false, timeout, 0, this});
+    };
+    for(const auto& w : workers) {
+      add_item(w.second, boot_key(e_component_worker, w.first));
+    }
+    for(const auto& h : handlers) {
+      add_item(h.second, boot_key(e_component_handler, h.first));
+    }
+    uninitialized.clear();
+  }
+  if(!boot_signal) {
+    boot_signal = xSemaphoreCreateCounting(255, 0);
+  }
+
+  uint8_t next_core = 0;
+  size_t remaining = boot_items.size();
+  bool stalled = false;
+  while(remaining) {
+    uint32_t now = Clock::get().millis();
+    uint32_t wait = portMAX_DELAY;
+    for(auto& item : boot_items) {
+      if(item.state == e_boot_pending) {
+        bool failed;
+        if(boot_dependencies_done(item, failed)) {
+          item.state = e_boot_running;
+          item.started = now;
+          TaskHandle_t task;
+          __sync_fetch_and_add(&boot_tasks, 1);
+          if(xTaskCreatePinnedToCore(Aggregator::run_boot_task, "boot", memory, &item, priority, &task, next_core) != pdPASS) {
+            __sync_fetch_and_sub(&boot_tasks, 1);
+            item.state = e_boot_failed;
+          }
+          next_core ^= 1;
+        } else if(failed) {
+          item.state = e_boot_failed;
+        }
+      } else if(item.state == e_boot_running && !item.timed_out && now - item.started >= item.timeout) {
+        item.timed_out = true;
+      }
+      if(item.state == e_boot_running && !item.timed_out) {
+        uint32_t left = item.timeout - (now - item.started);
+        wait = std::min(wait, (uint32_t) pdMS_TO_TICKS(left ? left : 1));
+      }
+    }
+    remaining = 0;
+    size_t running = 0;
+    for(const auto& item : boot_items) {
+      if(item.state == e_boot_pending) {
+        ++remaining;
+      } else if(item.state == e_boot_running && !item.timed_out) {
+        ++remaining;
+        ++running;
+      }
+    }
+    if(remaining && !running) {
+      if(!stalled) {
+        // A task may have finished during this pass, check the pending ones once more
+        stalled = true;
+        continue;
+      }
+      // Nothing runs that could complete a dependency of the pending ones: a dependency cycle
+      for(auto& item : boot_items) {
+        if(item.state == e_boot_pending) {
+          item.state = e_boot_failed;
+        }
+      }
+      break;
+    }
+    stalled = false;
+    if(remaining) {
+      // Wait until a task finished or the first timeout passed
+      xSemaphoreTake(boot_signal, wait);
+    }
+  }
+  boot_duration = Clock::get().millis() - boot_start;
+  return std::all_of(
+      boot_items.begin(),
+      boot_items.end(),
+      [](const BootItem& item) { return item.state == e_boot_done && !item.timed_out; }
+  );
+}
+
+bool Aggregator::component_active(uint16_t key) {
+  auto id = (uint8_t) key;
+  if(key >> 8 == e_component_worker) {
+    RecursiveLock lock(workers_mutex);
+    auto worker = workers.find(id);
+    return worker != workers.end() && worker->second && worker->second->active();
+  }
+  RecursiveLock lock(handlers_mutex);
+  auto handler = handlers.find(id);
+  return handler != handlers.end() && handler->second && handler->second->active();
+}
+
+void Aggregator::run_boot_task(void* instance) {
+  auto item = (BootItem*) instance;
+  Aggregator* aggregator = item->aggregator;
+  SemaphoreHandle_t boot_signal = aggregator->boot_signal;
+  if(item->initialize) {
+    item->component->initialize();
+  }
+  // Also when the boot already timed out: finishing late, the worker/handler may be active after all
+  BootState state = item->component->set_active(true) ? e_boot_done : e_boot_failed;
+  // Once the state is written a new boot may reuse the items, don't touch the item after it
+  __sync_synchronize();
+  item->state = state;
+  xSemaphoreGive(boot_signal);
+  // Last use of the aggregator, it may be destroyed after this
+  __sync_fetch_and_sub(&aggregator->boot_tasks, 1);
+  vTaskDelete(nullptr);
+}
+
+void Aggregator::set_sampling_grid(uint32_t grid_millis) {
+  RecursiveLock lock(workers_mutex);
+  sampling_grid = grid_millis ? grid_millis : 1;
+  for(const auto& w : workers) {
+    if(w.second) {
+      w.second->grid = sampling_grid;
+      w.second->schedule_started = false;
+    }
+  }
+}
+
+uint32_t Aggregator::get_millis_until_due() const {
+  uint32_t now = Clock::get().millis();
+  uint32_t until = UINT32_MAX;
+  for(const auto& w : workers) {
+    auto worker = w.second;
+    if(!worker || !worker->active()) {
+      continue;
+    }
+    if(worker->is_process_worker() && worker->get_schedule() == BaseWorker::e_schedule_break) {
+      // Produces when its sources are fresh
+      continue;
+    }
+    if(worker->task_running() || worker->status == BaseWorker::e_worker_processing) {
+      return 0;
+    }
+    int32_t left = (int32_t) (worker->get_next_due() - now);
+    if(left <= 0) {
+      return 0;
+    }
+    until = std::min(until, (uint32_t) left);
+  }
+  return until;
+}
@@ -0,0 +1,133 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "Arena.hpp"
+#include <stdarg.h>
+
+Arena::Arena(uint8_t* buffer, size_t capacity)
+    : buffer(buffer), size(capacity), offset(0), high_water(0), failed_allocations(0) {
+}
+
+void* Arena::allocate(size_t length, size_t alignment) {
+  uintptr_t start = ((uintptr_t) (buffer + offset) + alignment - 1) & ~(uintptr_t) (alignment - 1);
+  size_t begin = start - (uintptr_t) buffer;
+  if (begin > size || length > size - begin) {
+    ++failed_allocations;
+    return nullptr;
+  }
+  offset = begin + length;
+  if (offset > high_water) {
+    high_water = offset;
+  }
+  return buffer + begin;
+}
+
+Span<char> Arena::copy(const char* text) {
+  size_t length = strlen(text);
+  char* destination = (char*) allocate(length + 1, 1);
+  if (!destination) {
+    return Span<char>();
+  }
+  memcpy(destination, text, length + 1);
+  return Span<char>(destination, length);
+}
+
+Span<uint8_t> Arena::copy(const uint8_t* bytes, size_t length) {
+  uint8_t* destination = (uint8_t*) allocate(length, 1);
+  if (!destination) {
+    return Span<uint8_t>();
+  }
+  memcpy(destination, bytes, length);
+  return Span<uint8_t>(destination, length);
+}
+
+Span<char> Arena::printf(const char* format, ...) {
+  // Format straight into the free space, then claim only what was written
+  char* destination = (char*) (buffer + offset);
+  size_t space = size - offset;
+  va_list arguments;
+  va_start(arguments, format);
+  int length = vsnprintf(destination, space, format, arguments);
+  va_end(arguments);
+  if (length < 0 || (size_t) length >= space) {
+    ++failed_allocations;
+    return Span<char>();
+  }
+  allocate((size_t) length + 1, 1);
+  return Span<char>(destination, (size_t) length);
+}
+
+void Arena::reset() {
+  offset = 0;
+}
+
+size_t Arena::used() const {
+  return offset;
+}
+
+size_t Arena::remaining() const {
+  return size - offset;
+}
+
+size_t Arena::capacity() const {
+  return size;
+}
+
+size_t Arena::get_high_water() const {
+  return high_water;
+}
+
+uint32_t Arena::get_failed_allocations() const {
+  return failed_allocations;
+}
+
+BlockPool::BlockPool(uint8_t* buffer, size_t block_size, size_t block_count)
+    : buffer(buffer), block_size(block_size), block_count(block_count), free_list(nullptr), free_blocks(block_count),
+      failed_acquires(0) {
+  // Chain the blocks back to front, so the first acquire returns the first block
+  for (size_t i = block_count; i > 0; --i) {
+    auto block = (FreeBlock*) (buffer + (i - 1) * block_size);
+    block->next = free_list;
+    free_list = block;
+  }
+}
+
+void* BlockPool::acquire() {
+  if (!free_list) {
+    ++failed_acquires;
+    return nullptr;
+  }
+  FreeBlock* block = free_list;
+  free_list = block->next;
+  --free_blocks;
+  return block;
+}
+
+void BlockPool::release(void* block) {
+  if (!block) {
+    return;
+  }
+  auto free_block = (FreeBlock*) block;
+  free_block->next = free_list;
+  free_list = free_block;
+  ++free_blocks;
+}
+
+bool BlockPool::owns(const void* block) const {
+  auto address = (const uint8_t*) block;
+  return address >= buffer && address < buffer + block_size * block_count
+      && (size_t) (address - buffer) % block_size == 0;
+}
+
+size_t BlockPool::available() const {
+  return free_blocks;
+}
+
+size_t BlockPool::get_block_size() const {
+  return block_size;
+}
+
+uint32_t BlockPool::get_failed_acquires() const {
+  return failed_acquires;
+}
@@ -0,0 +1,111 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "Bus.hpp"
+
+WireBus::WireBus(TwoWire& wire, uint32_t clock_hz) : wire(wire), clock_hz(clock_hz) {
+}
+
+bool WireBus::begin_transaction() {
+  if (clock_hz) {
+    wire.setClock(clock_hz);
+  }
+  return true;
+}
+
+void WireBus::end_transaction() {
+}
+
+bool WireBus::read_register(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) {
+  wire.beginTransmission(address);
+  wire.write(reg);
+  // Repeated start, keep the bus for the read
+  if (wire.endTransmission(false) != 0) {
+    return false;
+  }
+  if (wire.requestFrom((int) address, (int) length) != length) {
+    return false;
+  }
+  for (uint8_t i = 0; i < length; ++i) {
+    buffer[i] = (uint8_t) wire.read();
+  }
+  return true;
+}
+
+bool WireBus::write_register(uint8_t address, uint8_t reg, const uint8_t* buffer, uint8_t length) {
+  wire.beginTransmission(address);
+  wire.write(reg);
+  wire.write(buffer, length);
+  return wire.endTransmission() == 0;
+}
+
+SimulatedBus::SimulatedBus(uint32_t transaction_micros, uint32_t byte_micros)
+    : transaction_micros(transaction_micros), byte_micros(byte_micros), in_transaction(false), stats() {
+}
+
+void SimulatedBus::set_register(uint8_t address, uint8_t reg, const uint8_t* buffer, uint8_t length) {
+  registers[(uint16_t) (address << 8 | reg)].assign(buffer, buffer + length);
+}
+
+void SimulatedBus::remove_device(uint8_t address) {
+  registers.erase(registers.lower_bound((uint16_t) (address << 8)),
+                  registers.upper_bound((uint16_t) (address << 8 | 0xFF)));
+}
+
+bool SimulatedBus::begin_transaction() {
+  if (in_transaction) {
+    return false;
+  }
+  in_transaction = true;
+  ++stats.transactions;
+  stats.busy_micros += transaction_micros;
+  return true;
+}
+
+void SimulatedBus::end_transaction() {
+  in_transaction = false;
+}
+
+void SimulatedBus::access(uint8_t length) {
+  if (!in_transaction) {
+    ++stats.transactions;
+    stats.busy_micros += transaction_micros;
+  }
+  stats.bytes += length + 2u;
+  stats.busy_micros += (length + 2u) * byte_micros;
+}
+
+bool SimulatedBus::read_register(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) {
+  access(length);
+  ++stats.reads;
+  auto found = registers.find((uint16_t) (address << 8 | reg));
+  if (found == registers.end()) {
+    ++stats.failures;
+    return false;
+  }
+  for (uint8_t i = 0; i < length; ++i) {
+    buffer[i] = i < found->second.size() ? found->second[i] : 0;
+  }
+  return true;
+}
+
+bool SimulatedBus::write_register(uint8_t address, uint8_t reg, const uint8_t* buffer, uint8_t length) {
+  access(length);
+  ++stats.writes;
+  auto found = registers.find((uint16_t) (address << 8 | reg));
+  if (found == registers.end()) {
+    ++stats.failures;
+    return false;
+  }
+  found->second.assign(buffer, buffer + length);
+  return true;
+}
+
+const SimulatedBus::Stats& SimulatedBus::get_stats() const {
+  return stats;
+}
+
+void SimulatedBus::reset_stats() {
+  stats = Stats();
+}
@@ -0,0 +1,137 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "BusArbiter.hpp"
+#include "Clock.hpp"
+
+BusArbiter::BusArbiter(Bus& bus)
+    : Worker<uint32_t>(0u, 0), bus(bus), mutex(xSemaphoreCreateRecursiveMutex()), coalesce_window(0), stats() {
+}
+
+BusArbiter::~BusArbiter() {
+  vSemaphoreDelete(mutex);
+}
+
+uint8_t BusArbiter::add_read(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length, uint32_t period) {
+  if (jobs.size() >= no_job) {
+    return no_job;
+  }
+  Job job = {address, reg, buffer, length, false, false, false, period, 0, 0};
+  jobs.push_back(job);
+  return (uint8_t) (jobs.size() - 1);
+}
+
+void BusArbiter::set_coalesce_window(uint32_t millis) {
+  coalesce_window = millis;
+}
+
+bool BusArbiter::job_completed(uint8_t job) const {
+  return job < jobs.size() && is_fresh() && jobs[job].started && jobs[job].burst == data;
+}
+
+bool BusArbiter::take_job(uint8_t job) {
+  if (job >= jobs.size() || !jobs[job].unread) {
+    return false;
+  }
+  jobs[job].unread = false;
+  return true;
+}
+
+bool BusArbiter::job_failed(uint8_t job) const {
+  return job < jobs.size() && jobs[job].failed;
+}
+
+bool BusArbiter::lock(uint32_t timeout_millis) {
+  TickType_t ticks = timeout_millis == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeout_millis);
+  return xSemaphoreTakeRecursive(mutex, ticks) == pdTRUE;
+}
+
+void BusArbiter::unlock() {
+  xSemaphoreGiveRecursive(mutex);
+}
+
+bool BusArbiter::read_register(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) {
+  if (!lock()) {
+    return false;
+  }
+  bool success = bus.begin_transaction();
+  if (success) {
+    success = bus.read_register(address, reg, buffer, length);
+    bus.end_transaction();
+  }
+  unlock();
+  return success;
+}
+
+bool BusArbiter::write_register(uint8_t address, uint8_t reg, const uint8_t* buffer, uint8_t length) {
+  if (!lock()) {
+    return false;
+  }
+  bool success = bus.begin_transaction();
+  if (success) {
+    success = bus.write_register(address, reg, buffer, length);
+    bus.end_transaction();
+  }
+  unlock();
+  return success;
+}
+
+Bus& BusArbiter::get_bus() {
+  return bus;
+}
+
+const BusArbiter::Stats& BusArbiter::get_stats() const {
+  return stats;
+}
+
+int8_t BusArbiter::produce_data() {
+  uint32_t now = Clock::get().millis();
+  bool any_due = false;
+  for (const auto& job : jobs) {
+    if (!job.started || (int32_t) (now - job.next_due) >= 0) {
+      any_due = true;
+      break;
+    }
+  }
+  if (!any_due) {
+    return e_worker_idle;
+  }
+  // Never block the loop on an async task using the bus, try again next run
+  if (!lock(0)) {
+    ++stats.contended;
+    return e_worker_idle;
+  }
+  if (!bus.begin_transaction()) {
+    unlock();
+    return e_worker_error;
+  }
+  uint32_t burst = data + 1;
+  for (auto& job : jobs) {
+    int32_t early = job.started ? (int32_t) (job.next_due - now) : 0;
+    if (early > (int32_t) coalesce_window) {
+      continue;
+    }
+    if (early > 0) {
+      ++stats.coalesced;
+    }
+    job.failed = !bus.read_register(job.address, job.reg, job.buffer, job.length);
+    if (job.failed) {
+      ++stats.failed_reads;
+    }
+    ++stats.reads;
+    job.burst = burst;
+    job.unread = true;
+    // Fixed rate, but start over from now when a full period behind
+    job.next_due = job.started ? job.next_due + job.period : now + job.period;
+    if ((int32_t) (now - job.next_due) >= 0) {
+      job.next_due = now + job.period;
+    }
+    job.started = true;
+  }
+  bus.end_transaction();
+  unlock();
+  ++stats.bursts;
+  data = burst;
+  return e_worker_data_read;
+}
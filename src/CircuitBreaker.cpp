@@ -0,0 +1,91 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "CircuitBreaker.hpp"
+
+CircuitBreaker::CircuitBreaker()
+    : state(e_breaker_closed), threshold(0), window(32), open_millis(0), outcomes(0), opened_at(0), trips(0),
+      rejected(0), probe_in_flight(false) {
+}
+
+void CircuitBreaker::configure(uint8_t _threshold, uint8_t _window, uint32_t _open_millis) {
+  window = _window == 0 || _window > 32 ? 32 : _window;
+  threshold = _threshold > window ? window : _threshold;
+  open_millis = _open_millis;
+  reset();
+}
+
+bool CircuitBreaker::allow(uint32_t now) {
+  switch (state) {
+    case e_breaker_open:
+      if (now - opened_at < open_millis) {
+        ++rejected;
+        return false;
+      }
+      state = e_breaker_half_open;
+      probe_in_flight = true;
+      return true;
+    case e_breaker_half_open:
+      if (probe_in_flight) {
+        ++rejected;
+        return false;
+      }
+      probe_in_flight = true;
+      return true;
+    default:
+      return true;
+  }
+}
+
+void CircuitBreaker::record(bool success, uint32_t now) {
+  if (threshold == 0) {
+    return;
+  }
+  if (state == e_breaker_half_open) {
+    probe_in_flight = false;
+    if (success) {
+      reset();
+    } else {
+      open(now);
+    }
+    return;
+  }
+  outcomes = (outcomes << 1) | (success ? 0 : 1);
+  if (state == e_breaker_closed && get_failures() >= threshold) {
+    open(now);
+  }
+}
+
+void CircuitBreaker::cancel_probe() {
+  probe_in_flight = false;
+}
+
+void CircuitBreaker::open(uint32_t now) {
+  state = e_breaker_open;
+  opened_at = now;
+  ++trips;
+}
+
+void CircuitBreaker::reset() {
+  state = e_breaker_closed;
+  outcomes = 0;
+  probe_in_flight = false;
+}
+
+CircuitBreaker::State CircuitBreaker::get_state() const {
+  return state;
+}
+
+uint8_t CircuitBreaker::get_failures() const {
+  uint32_t mask = window == 32 ? UINT32_MAX : (1u << window) - 1;
+  return (uint8_t) __builtin_popcount(outcomes & mask);
+}
+
+uint32_t CircuitBreaker::get_trips() const {
+  return trips;
+}
+
+uint32_t CircuitBreaker::get_rejected() const {
+  return rejected;
+}
@@ -0,0 +1,63 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "Clock.hpp"
+
+Clock Clock::system_clock;
+Clock* Clock::current = &Clock::system_clock;
+
+uint32_t Clock::millis() const {
+  return ::millis();
+}
+
+uint32_t Clock::micros() const {
+  return ::micros();
+}
+
+Clock& Clock::get() {
+  return *current;
+}
+
+void Clock::set(Clock& clock) {
+  current = &clock;
+}
+
+void Clock::reset() {
+  current = &system_clock;
+}
+
+VirtualClock::VirtualClock(uint32_t start_millis)
+    : Clock(), time_micros((uint64_t) start_millis * 1000), speed(0), anchor_micros(0) {
+}
+
+uint64_t VirtualClock::elapsed_micros() const {
+  if (speed == 0) {
+    return time_micros;
+  }
+  return time_micros + (uint64_t) (::micros() - anchor_micros) * speed;
+}
+
+uint32_t VirtualClock::millis() const {
+  return (uint32_t) (elapsed_micros() / 1000);
+}
+
+uint32_t VirtualClock::micros() const {
+  return (uint32_t) elapsed_micros();
+}
+
+void VirtualClock::set_time(uint32_t time_millis) {
+  time_micros = (uint64_t) time_millis * 1000;
+  speed = 0;
+}
+
+void VirtualClock::advance(uint32_t duration_millis) {
+  time_micros = elapsed_micros() + (uint64_t) duration_millis * 1000;
+  anchor_micros = ::micros();
+}
+
+void VirtualClock::set_speed(uint32_t _speed) {
+  time_micros = elapsed_micros();
+  anchor_micros = ::micros();
+  speed = _speed;
+}
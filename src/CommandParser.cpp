@@ -0,0 +1,74 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "CommandParser.hpp"
+
+CommandParser::CommandParser(const CommandSpec* table, size_t size) : table(table), size(size) {
+}
+
+static const char* skip_spaces(const char* text) {
+  while (*text == ' ' || *text == '\t') {
+    ++text;
+  }
+  return text;
+}
+
+static bool parse_bool(const char* text, int32_t& value) {
+  if (!strcmp(text, "1") || !strcasecmp(text, "on") || !strcasecmp(text, "true")) {
+    value = 1;
+  } else if (!strcmp(text, "0") || !strcasecmp(text, "off") || !strcasecmp(text, "false")) {
+    value = 0;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool CommandParser::parse(const char* line, Command& command) const {
+  command = Command{Command::e_command_unknown, 0, 0, 0, nullptr, 0};
+  line = skip_spaces(line);
+
+  const CommandSpec* spec = nullptr;
+  size_t name_length = 0;
+  for (size_t i = 0; i < size; ++i) {
+    size_t length = strlen(table[i].name);
+    if (length > name_length && !strncmp(line, table[i].name, length)) {
+      spec = &table[i];
+      name_length = length;
+    }
+  }
+  if (!spec) {
+    return false;
+  }
+  command.type = spec->type;
+
+  const char* argument = skip_spaces(line + name_length);
+  char* end = nullptr;
+  bool valid = true;
+  switch (spec->argument) {
+    case CommandSpec::e_arg_none:
+      valid = *argument == '\0';
+      break;
+    case CommandSpec::e_arg_int:
+      command.int_value = (int32_t) strtol(argument, &end, 10);
+      valid = end != argument && *skip_spaces(end) == '\0';
+      command.float_value = (float) command.int_value;
+      break;
+    case CommandSpec::e_arg_float:
+      command.float_value = strtof(argument, &end);
+      valid = end != argument && *skip_spaces(end) == '\0';
+      command.int_value = (int32_t) command.float_value;
+      break;
+    case CommandSpec::e_arg_bool:
+      valid = parse_bool(argument, command.int_value);
+      command.float_value = (float) command.int_value;
+      break;
+    case CommandSpec::e_arg_word:
+      command.word = argument;
+      command.word_length = strlen(argument);
+      break;
+  }
+  command.status = valid ? Command::e_command_ok : Command::e_command_bad_argument;
+  return valid;
+}
@@ -0,0 +1,94 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "CorePlacement.hpp"
+
+CorePlacement::Stats CorePlacement::stats = {};
+uint32_t CorePlacement::bias[SENSOR_REPORTER_CORES] = {};
+uint32_t CorePlacement::half_life = 1000;
+uint32_t CorePlacement::last_decay = 0;
+portMUX_TYPE CorePlacement::lock = portMUX_INITIALIZER_UNLOCKED;
+
+void CorePlacement::decay(uint32_t now) {
+  uint32_t periods = half_life ? (now - last_decay) / half_life : 0;
+  if (periods == 0) {
+    return;
+  }
+  for (auto& busy : stats.busy_micros) {
+    busy = periods >= 32 ? 0 : busy >> periods;
+  }
+  last_decay += periods * half_life;
+}
+
+uint8_t CorePlacement::place(uint8_t requested) {
+  // millis() and not the framework clock: this is about real cpu time
+  uint32_t now = millis();
+  portENTER_CRITICAL(&lock);
+  decay(now);
+  uint8_t core = requested;
+  if (core == core_auto) {
+    core = 0;
+    for (uint8_t i = 1; i < SENSOR_REPORTER_CORES; ++i) {
+      uint64_t load = (uint64_t) stats.busy_micros[i] + bias[i];
+      uint64_t best_load = (uint64_t) stats.busy_micros[core] + bias[core];
+      if (stats.in_flight[i] < stats.in_flight[core]
+          || (stats.in_flight[i] == stats.in_flight[core] && load < best_load)) {
+        core = i;
+      }
+    }
+    ++stats.automatic;
+  } else if (core >= SENSOR_REPORTER_CORES) {
+    core = SENSOR_REPORTER_CORES - 1;
+  }
+  ++stats.placements[core];
+  ++stats.in_flight[core];
+  stats.last_core = core;
+  portEXIT_CRITICAL(&lock);
+  return core;
+}
+
+void CorePlacement::finish(uint8_t core, uint32_t busy_micros) {
+  if (core >= SENSOR_REPORTER_CORES) {
+    return;
+  }
+  uint32_t now = millis();
+  portENTER_CRITICAL(&lock);
+  decay(now);
+  if (stats.in_flight[core]) {
+    --stats.in_flight[core];
+  }
+  stats.busy_micros[core] += busy_micros;
+  portEXIT_CRITICAL(&lock);
+}
+
+void CorePlacement::set_core_bias(uint8_t core, uint32_t busy_micros) {
+  if (core < SENSOR_REPORTER_CORES) {
+    portENTER_CRITICAL(&lock);
+    bias[core] = busy_micros;
+    portEXIT_CRITICAL(&lock);
+  }
+}
+
+void CorePlacement::set_half_life(uint32_t half_life_millis) {
+  portENTER_CRITICAL(&lock);
+  half_life = half_life_millis;
+  portEXIT_CRITICAL(&lock);
+}
+
+CorePlacement::Stats CorePlacement::get_stats() {
+  portENTER_CRITICAL(&lock);
+  Stats copy = stats;
+  portEXIT_CRITICAL(&lock);
+  return copy;
+}
+
+void CorePlacement::reset_stats() {
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = 0; i < SENSOR_REPORTER_CORES; ++i) {
+    stats.placements[i] = 0;
+    stats.busy_micros[i] = 0;
+  }
+  stats.automatic = 0;
+  portEXIT_CRITICAL(&lock);
+}
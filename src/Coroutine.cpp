@@ -0,0 +1,29 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "Coroutine.hpp"
+
+static_assert(Coroutine::suspended == BaseWorker::e_worker_processing, "suspended must mean processing");
+static_assert(Coroutine::suspended == Handler::e_handler_processing, "suspended must mean processing");
+
+CoHandler::CoHandler() : Handler(), co(), workers(nullptr) {
+}
+
+int8_t CoHandler::handle_produced_work(const WorkerMap& _workers) {
+  workers = &_workers;
+  co.reset();
+  return step();
+}
+
+int8_t CoHandler::resume_async() {
+  return workers ? step() : (int8_t) e_handler_idle;
+}
+
+int8_t CoHandler::step() {
+  int8_t result = handle_coroutine(*workers);
+  if (result != Coroutine::suspended) {
+    co.reset();
+  }
+  return result;
+}
@@ -0,0 +1,46 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "DisplayBackend.hpp"
+
+MemoryDisplay::MemoryDisplay(uint16_t columns, uint16_t rows)
+    : DisplayBackend(), columns(columns), rows(rows), cells((columns + 1) * rows, ' '), draw_calls(0),
+      chars_drawn(0), batches(0) {
+  for (uint16_t row = 0; row < rows; ++row) {
+    cells[row * (columns + 1) + columns] = '\0';
+  }
+}
+
+void MemoryDisplay::begin_batch() {
+  ++batches;
+}
+
+void MemoryDisplay::draw_text(uint16_t column, uint16_t row, const char* text, size_t length) {
+  ++draw_calls;
+  if (row >= rows || column >= columns) {
+    return;
+  }
+  length = std::min(length, (size_t) (columns - column));
+  memcpy(&cells[row * (columns + 1) + column], text, length);
+  chars_drawn += length;
+}
+
+void MemoryDisplay::end_batch() {
+}
+
+const char* MemoryDisplay::get_row(uint16_t row) const {
+  return row < rows ? &cells[row * (columns + 1)] : "";
+}
+
+uint32_t MemoryDisplay::get_draw_calls() const {
+  return draw_calls;
+}
+
+uint32_t MemoryDisplay::get_chars_drawn() const {
+  return chars_drawn;
+}
+
+uint32_t MemoryDisplay::get_batches() const {
+  return batches;
+}
@@ -0,0 +1,100 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "DisplaySupervisor.hpp"
+
+DisplaySupervisor::DisplaySupervisor(DisplayBackend& display) : Supervisor(), display(display), full_redraw(true) {
+}
+
+size_t DisplaySupervisor::add(uint16_t column, uint16_t row, uint16_t width, Source source, uint8_t source_id,
+                              Formatter formatter) {
+  fields.push_back(Field{column, row, width, source, source_id, Handler::e_handler_idle, formatter, shadow.size()});
+  shadow.resize(shadow.size() + width, ' ');
+  if (scratch.size() < (size_t) width + 1) {
+    scratch.resize(width + 1);
+  }
+  full_redraw = true;
+  return fields.size() - 1;
+}
+
+size_t DisplaySupervisor::add_worker_field(uint16_t column, uint16_t row, uint16_t width, uint8_t worker_id,
+                                           Formatter formatter) {
+  return add(column, row, width, e_source_worker, worker_id, formatter);
+}
+
+size_t DisplaySupervisor::add_handler_field(uint16_t column, uint16_t row, uint16_t width, uint8_t handler_id,
+                                            Formatter formatter) {
+  return add(column, row, width, e_source_handler, handler_id, formatter);
+}
+
+size_t DisplaySupervisor::add_field(uint16_t column, uint16_t row, uint16_t width, Formatter formatter) {
+  return add(column, row, width, e_source_always, 0, formatter);
+}
+
+void DisplaySupervisor::invalidate() {
+  full_redraw = true;
+}
+
+void DisplaySupervisor::initialize() {
+  invalidate();
+}
+
+bool DisplaySupervisor::needs_format(Field& field, const WorkerMap& workers, const HandlerMap& handlers) {
+  switch (field.source) {
+    case e_source_worker: {
+      auto worker = workers.find(field.source_id);
+      return worker != workers.end() && worker->second && worker->second->is_fresh();
+    }
+    case e_source_handler: {
+      auto handler = handlers.find(field.source_id);
+      if (handler == handlers.end() || !handler->second || handler->second->get_status() == field.last_status) {
+        return false;
+      }
+      field.last_status = handler->second->get_status();
+      return true;
+    }
+    default:
+      return true;
+  }
+}
+
+void DisplaySupervisor::handle_report(const WorkerMap& workers, const HandlerMap& handlers) {
+  bool redraw = full_redraw;
+  bool batch_started = false;
+  for (auto& field : fields) {
+    if (!needs_format(field, workers, handlers) && !redraw) {
+      continue;
+    }
+    // Render into scratch, padded to the field width
+    size_t length = field.formatter(workers, handlers, scratch.data(), field.width + 1);
+    length = std::min(length, (size_t) field.width);
+    memset(scratch.data() + length, ' ', field.width - length);
+
+    // Only draw the part of the field that differs from the shadow buffer
+    char* shadow_field = &shadow[field.shadow_offset];
+    size_t first = 0;
+    size_t last = field.width;
+    if (!redraw) {
+      while (first < last && scratch[first] == shadow_field[first]) {
+        ++first;
+      }
+      while (last > first && scratch[last - 1] == shadow_field[last - 1]) {
+        --last;
+      }
+    }
+    if (first == last) {
+      continue;
+    }
+    if (!batch_started) {
+      display.begin_batch();
+      batch_started = true;
+    }
+    display.draw_text(field.column + first, field.row, scratch.data() + first, last - first);
+    memcpy(shadow_field + first, scratch.data() + first, last - first);
+  }
+  if (batch_started) {
+    display.end_batch();
+  }
+  full_redraw = false;
+}
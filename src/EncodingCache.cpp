@@ -0,0 +1,56 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "EncodingCache.hpp"
+#include "Worker.hpp"
+
+EncodingCache::EncodingCache(size_t capacity, uint8_t max_entries)
+    : capacity(capacity), max_entries(max_entries), used(0), stats() {
+}
+
+const uint8_t* EncodingCache::encode(const BaseWorker& worker, uint8_t format, Encoder encoder, size_t& length) {
+  length = 0;
+  for (auto& entry : entries) {
+    if (entry.worker_id == worker.get_id() && entry.format == format) {
+      if (entry.produce_count == worker.get_produce_count()) {
+        ++stats.hits;
+        length = entry.length;
+        return entry.length ? buffer.data() + entry.offset : nullptr;
+      }
+      // Worker produced again, the space of the old encoding is not reclaimed until the next run
+      entry = entries.back();
+      entries.pop_back();
+      break;
+    }
+  }
+  if (buffer.empty()) {
+    // Reserve the memory on first use
+    buffer.resize(capacity);
+    entries.reserve(max_entries);
+  }
+  if (entries.size() >= max_entries) {
+    ++stats.overflows;
+    return nullptr;
+  }
+  ++stats.encodes;
+  size_t encoded = encoder(worker, buffer.data() + used, capacity - used);
+  if (encoded >= capacity - used) {
+    ++stats.overflows;
+    return nullptr;
+  }
+  entries.push_back(Entry{worker.get_id(), format, worker.get_produce_count(), used, encoded});
+  const uint8_t* result = encoded ? buffer.data() + used : nullptr;
+  used += encoded;
+  length = encoded;
+  return result;
+}
+
+void EncodingCache::clear() {
+  entries.clear();
+  used = 0;
+}
+
+const EncodingCache::Stats& EncodingCache::get_stats() const {
+  return stats;
+}
@@ -3,15 +3,27 @@
 //
 
 #include "Handler.hpp"
+#include "Tracer.hpp"
+#include "Clock.hpp"
 
-Handler::Handler() : Activatable(), status(e_handler_idle) {
+Handler::Handler()
+    : Activatable(), status(e_handler_idle), async_result_status(e_handler_idle), xAsyncHandlerHandle(nullptr),
+      task_core(0), task_started(0), id(0), latency_tracking(false), latencies_mutex(xSemaphoreCreateMutex()) {
+}
+
+Handler::~Handler() {
+  vSemaphoreDelete(latencies_mutex);
 }
 
 int8_t Handler::get_status() const {
   return status;
 }
 
-void Handler::try_handle_work(const WorkerMap& workers) {
+uint8_t Handler::get_id() const {
+  return id;
+}
+
+bool Handler::prepare_handling() {
   if(get_active_state() == e_state_activating_failed) {
     // Still activating, will try to activate again
     set_active(true);
@@ -19,15 +31,123 @@ void Handler::try_handle_work(const WorkerMap& workers) {
   if(active()) {
     if (!task_running()) {
       if (status == e_handler_processing) {
-        // Task completed async, set status based on result
-        status = async_result_status;
-        async_result_status = e_handler_idle;
+        int8_t result = resume_async();
+        if (result != e_handler_processing) {
+          // Completed async, set status based on result
+          status = result;
+          async_result_status = e_handler_idle;
+          record_outcome(status);
+          record_latency();
+        }
+      } else if (breaker_allows()) {
+        return true;
       } else {
-        // handle data normally
-        status = handle_produced_work(workers);
+        // Circuit open, skip handling
+        status = e_handler_idle;
       }
     }
   }
+  return false;
+}
+
+void Handler::try_handle_work(const WorkerMap& workers) {
+  SR_TRACE_SCOPE(Tracer::e_trace_handler, Tracer::e_trace_handle, id);
+  if(prepare_handling()) {
+    // handle data normally
+    tag_latency(workers);
+    status = handle_produced_work(workers);
+    record_outcome(status);
+    record_latency();
+  }
+}
+
+void Handler::try_handle_snapshot(const TickSnapshot* snapshot) {
+  SR_TRACE_SCOPE(Tracer::e_trace_handler, Tracer::e_trace_handle, id);
+  if(prepare_handling() && snapshot) {
+    tag_latency(*snapshot);
+    status = handle_produced_snapshot(*snapshot);
+    record_outcome(status);
+    record_latency();
+  }
+}
+
+void Handler::set_latency_tracking(bool enabled) {
+  latency_tracking = enabled;
+  latency_tags.clear();
+}
+
+const LatencyHistogram* Handler::get_latency(uint8_t worker_id) const {
+  xSemaphoreTake(latencies_mutex, portMAX_DELAY);
+  auto it = latencies.find(worker_id);
+  // Histograms are never removed, the pointer stays valid
+  const LatencyHistogram* latency = it != latencies.end() ? &it->second : nullptr;
+  xSemaphoreGive(latencies_mutex);
+  return latency;
+}
+
+void Handler::dump_latencies(Print& out) const {
+  char prefix[32];
+  xSemaphoreTake(latencies_mutex, portMAX_DELAY);
+  for (const auto& latency : latencies) {
+    int length = snprintf(prefix, sizeof(prefix), "handler %u worker %u: ", id, latency.first);
+    out.write((const uint8_t*) prefix, (size_t) length);
+    latency.second.dump(out);
+  }
+  xSemaphoreGive(latencies_mutex);
+}
+
+void Handler::tag_latency(const WorkerMap& workers) {
+  if (!latency_tracking) {
+    return;
+  }
+  latency_tags.clear();
+  for (const auto& w : workers) {
+    if (w.second && w.second->is_fresh()) {
+      latency_tags.push_back(LatencyTag{w.first, w.second->get_produce_micros()});
+    }
+  }
+}
+
+void Handler::tag_latency(const TickSnapshot& snapshot) {
+  if (!latency_tracking) {
+    return;
+  }
+  latency_tags.clear();
+  for (size_t i = 0; i < snapshot.get_worker_count(); ++i) {
+    uint8_t worker_id = snapshot.get_worker_id(i);
+    if (snapshot.is_fresh(worker_id)) {
+      latency_tags.push_back(LatencyTag{worker_id, snapshot.get_produce_micros(worker_id)});
+    }
+  }
+}
+
+void Handler::record_latency() {
+  if (status != e_handler_data_handled || latency_tags.empty()) {
+    // Not handled (yet), keep the tags while processing async
+    if (status != e_handler_processing) {
+      latency_tags.clear();
+    }
+    return;
+  }
+  uint32_t now = Clock::get().micros();
+  xSemaphoreTake(latencies_mutex, portMAX_DELAY);
+  for (const auto& tag : latency_tags) {
+    latencies[tag.worker_id].record(now - tag.produce_micros);
+  }
+  xSemaphoreGive(latencies_mutex);
+  latency_tags.clear();
+}
+
+int8_t Handler::handle_produced_snapshot(const TickSnapshot& snapshot) {
+  return e_handler_idle;
+}
+
+bool Handler::handles_snapshots() const {
+  return false;
+}
+
+bool Handler::handles_every_run() const {
+  return false;
 }
 
 int8_t Handler::handle_async() {
@@ -38,14 +158,24 @@ int8_t Handler::start_task(const char* task_name, uint32_t memory, uint8_t prior
   if (xAsyncHandlerHandle != nullptr) {
     return e_handler_processing; // already handling
   }
-  xTaskCreatePinnedToCore(Handler::run_task, task_name, memory, this, priority, &xAsyncHandlerHandle, core);
+  task_core = CorePlacement::place(core);
+  task_started = micros();
+  if (xTaskCreatePinnedToCore(Handler::run_task, task_name, memory, this, priority, &xAsyncHandlerHandle, task_core) != pdPASS) {
+    CorePlacement::finish(task_core, 0);
+  }
   return e_handler_processing;
 }
 
+int8_t Handler::resume_async() {
+  return async_result_status;
+}
+
 void Handler::kill_task() {
-  if (task_running()) {
-    vTaskDelete(xAsyncHandlerHandle);
-    xAsyncHandlerHandle = nullptr;
+  TaskHandle_t handle = xAsyncHandlerHandle;
+  // Claim the handle, so only one of kill_task and run_task counts the task as finished
+  if (handle != nullptr && __sync_bool_compare_and_swap(&xAsyncHandlerHandle, handle, nullptr)) {
+    vTaskDelete(handle);
+    CorePlacement::finish(task_core, micros() - task_started);
   }
 }
 
@@ -55,7 +185,14 @@ bool Handler::task_running() const {
 
 void Handler::run_task(void* instance) {
   auto handler = (Handler*) instance;
-  handler->async_result_status = handler->handle_async();
-  handler->xAsyncHandlerHandle = nullptr;
+  {
+    SR_TRACE_SCOPE(Tracer::e_trace_handler, Tracer::e_trace_task, handler->id);
+    handler->async_result_status = handler->handle_async();
+  }
+  if (!__sync_bool_compare_and_swap(&handler->xAsyncHandlerHandle, xTaskGetCurrentTaskHandle(), nullptr)) {
+    vTaskSuspend(nullptr); // kill_task claimed the handle and deletes this task
+    return;
+  }
+  CorePlacement::finish(handler->task_core, micros() - handler->task_started);
   vTaskDelete(nullptr);
 }
@@ -0,0 +1,233 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "HttpUplinkHandler.hpp"
+#include <algorithm>
+#include "Clock.hpp"
+
+HttpUplinkHandler::HttpUplinkHandler(UplinkTransport& transport, const char* host, const char* path,
+                                     size_t queue_size, uint16_t batch_records, uint32_t max_delay_millis)
+    : Handler(), transport(transport), host(host), path(path), extra_header(nullptr), queue(queue_size),
+      queue_used(0), queued_records(0), batch_records(batch_records), max_delay(max_delay_millis), oldest_record(0),
+      batched_bytes(0), in_flight(0), max_in_flight(4), pipelining(true), response(), backoff_initial(500),
+      backoff_max(60000), backoff(0), next_attempt(0), stats() {
+}
+
+void HttpUplinkHandler::set_extra_header(const char* header) {
+  extra_header = header;
+}
+
+void HttpUplinkHandler::set_max_in_flight(uint8_t _max_in_flight) {
+  max_in_flight = _max_in_flight ? _max_in_flight : 1;
+}
+
+void HttpUplinkHandler::set_backoff(uint32_t initial_millis, uint32_t max_millis) {
+  backoff_initial = initial_millis;
+  backoff_max = max_millis;
+}
+
+const HttpUplinkHandler::Stats& HttpUplinkHandler::get_stats() const {
+  return stats;
+}
+
+bool HttpUplinkHandler::activate(bool retry) {
+  uint32_t now = Clock::get().millis();
+  if (retry && (int32_t) (now - next_attempt) < 0) {
+    // Backing off, don't try to connect yet
+    return false;
+  }
+  if (transport.connect()) {
+    backoff = 0;
+    return true;
+  }
+  backoff = backoff ? std::min(backoff * 2, backoff_max) : backoff_initial;
+  next_attempt = now + backoff;
+  return false;
+}
+
+void HttpUplinkHandler::deactivate() {
+  transport.close();
+  // Batches without a response stay queued, they are sent again on the next connection
+  in_flight = 0;
+  response = Response();
+}
+
+int8_t HttpUplinkHandler::handle_produced_work(const WorkerMap& workers) {
+  if (!transport.connected()) {
+    ++stats.connection_losses;
+    // Reconnect now, retries with backoff on the next runs when it fails
+    set_active(false);
+    set_active(true);
+    return e_uplink_connection_lost;
+  }
+  read_responses();
+
+  bool fresh = std::any_of(workers.begin(), workers.end(), [](const std::pair<uint8_t, BaseWorker*>& pair) {
+    return pair.second->is_fresh();
+  });
+  // Without fresh data the run only services the queue and the connection
+  int8_t result = fresh ? queue_record(workers) : (int8_t) e_handler_idle;
+  if (queued_records && (
+      queued_records >= batch_records
+      || Clock::get().millis() - oldest_record >= max_delay
+      || result == e_uplink_queue_full
+  )) {
+    close_batch();
+  }
+  while (in_flight < batches.size() && in_flight < (pipelining ? max_in_flight : 1)) {
+    if (!send_batch()) {
+      ++stats.connection_losses;
+      set_active(false);
+      set_active(true);
+      return e_uplink_connection_lost;
+    }
+  }
+  return result;
+}
+
+int8_t HttpUplinkHandler::queue_record(const WorkerMap& workers) {
+  size_t separator = queued_records ? 1 : 0;
+  if (queue_used + separator >= queue.size()) {
+    // No room until responses free the batches, the pending records are still sent
+    ++stats.records_dropped;
+    return e_uplink_queue_full;
+  }
+  size_t capacity = queue.size() - queue_used - separator;
+  size_t length = encode_record(workers, queue.data() + queue_used + separator, capacity);
+  if (length >= capacity) {
+    ++stats.records_dropped;
+    return e_uplink_queue_full;
+  }
+  if (!length) {
+    return e_handler_idle;
+  }
+  if (separator) {
+    queue[queue_used] = ',';
+  } else {
+    oldest_record = Clock::get().millis();
+  }
+  queue_used += separator + length;
+  ++queued_records;
+  ++stats.records_queued;
+  return e_handler_data_handled;
+}
+
+bool HttpUplinkHandler::handles_every_run() const {
+  return true;
+}
+
+bool HttpUplinkHandler::write_all(const uint8_t* buffer, size_t length) {
+  return transport.write(buffer, length) == length;
+}
+
+void HttpUplinkHandler::close_batch() {
+  batches.push_back(Batch{queued_records, queue_used - batched_bytes});
+  batched_bytes = queue_used;
+  queued_records = 0;
+}
+
+bool HttpUplinkHandler::send_batch() {
+  size_t offset = 0;
+  for (uint8_t i = 0; i < in_flight; ++i) {
+    offset += batches[i].bytes;
+  }
+  const Batch& batch = batches[in_flight];
+  char header[256];
+  int header_length = snprintf(
+      header,
+      sizeof(header),
+      "POST %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\nContent-Type: application/json\r\n"
+      "Content-Length: %u\r\n%s%s\r\n",
+      path,
+      host,
+      (unsigned) (batch.bytes + 2),
+      extra_header ? extra_header : "",
+      extra_header ? "\r\n" : ""
+  );
+  if (header_length <= 0 || (size_t) header_length >= sizeof(header)) {
+    return false;
+  }
+  if (!write_all((const uint8_t*) header, header_length)
+      || !write_all((const uint8_t*) "[", 1)
+      || !write_all((const uint8_t*) queue.data() + offset, batch.bytes)
+      || !write_all((const uint8_t*) "]", 1)) {
+    // Keep the batch, it is sent again after reconnecting
+    return false;
+  }
+  ++stats.requests;
+  ++in_flight;
+  return true;
+}
+
+void HttpUplinkHandler::read_responses() {
+  uint8_t chunk[64];
+  while (in_flight && transport.available() > 0) {
+    size_t length = transport.read(chunk, sizeof(chunk));
+    if (!length) {
+      return;
+    }
+    for (size_t i = 0; i < length; ++i) {
+      char c = (char) chunk[i];
+      if (response.state == Response::e_body) {
+        if (--response.content_length == 0) {
+          finish_response();
+        }
+      } else if (c == '\n') {
+        response.line[response.line_length] = '\0';
+        handle_response_line();
+        response.line_length = 0;
+      } else if (c != '\r' && response.line_length < sizeof(response.line) - 1) {
+        response.line[response.line_length++] = c;
+      }
+    }
+  }
+}
+
+void HttpUplinkHandler::handle_response_line() {
+  const char* line = response.line;
+  if (response.state == Response::e_status_line) {
+    if (strncmp(line, "HTTP/1.", 7) != 0) {
+      return;
+    }
+    // HTTP/1.0 closes by default, and does not support pipelining
+    response.close = line[7] == '0';
+    response.status_code = atoi(line + 9);
+    response.state = Response::e_headers;
+  } else if (response.line_length == 0) {
+    // End of the headers
+    if (response.content_length) {
+      response.state = Response::e_body;
+    } else {
+      finish_response();
+    }
+  } else if (!strncasecmp(line, "Content-Length:", 15)) {
+    response.content_length = strtoul(line + 15, nullptr, 10);
+  } else if (!strncasecmp(line, "Connection:", 11)) {
+    response.close = strstr(line + 11, "close") != nullptr || strstr(line + 11, "Close") != nullptr;
+  }
+}
+
+void HttpUplinkHandler::finish_response() {
+  if (in_flight) {
+    Batch batch = batches.front();
+    if (response.status_code >= 200 && response.status_code < 300) {
+      stats.records_sent += batch.records;
+    } else {
+      ++stats.failed_requests;
+      stats.records_dropped += batch.records;
+    }
+    // Free the space of the batch
+    memmove(queue.data(), queue.data() + batch.bytes, queue_used - batch.bytes);
+    queue_used -= batch.bytes;
+    batched_bytes -= batch.bytes;
+    batches.erase(batches.begin());
+    --in_flight;
+  }
+  if (response.close) {
+    // Server does not keep the connection alive, reconnect on the next run
+    pipelining = false;
+    transport.close();
+  }
+  response = Response();
+}
@@ -0,0 +1,92 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "LatencyHistogram.hpp"
+
+LatencyHistogram::LatencyHistogram() : counts(), total(0), count(0), sum(0), max(0) {
+}
+
+uint8_t LatencyHistogram::bucket_index(uint32_t micros) {
+  const uint32_t sub_buckets = 1u << sub_bucket_bits;
+  if (micros < sub_buckets) {
+    return (uint8_t) micros;
+  }
+  // Position of the highest bit selects the power of 2, the bits below it the linear sub bucket
+  uint8_t exponent = 31 - __builtin_clz(micros);
+  uint8_t sub = (micros >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+  return (uint8_t) (((exponent - sub_bucket_bits + 1) << sub_bucket_bits) + sub);
+}
+
+uint32_t LatencyHistogram::bucket_upper_bound(uint8_t index) {
+  const uint32_t sub_buckets = 1u << sub_bucket_bits;
+  if (index < sub_buckets) {
+    return index;
+  }
+  uint8_t shift = (index >> sub_bucket_bits) - 1;
+  uint64_t upper = ((uint64_t) (sub_buckets + (index & (sub_buckets - 1)) + 1) << shift) - 1;
+  return upper > UINT32_MAX ? UINT32_MAX : (uint32_t) upper;
+}
+
+void LatencyHistogram::record(uint32_t micros) {
+  uint8_t index = bucket_index(micros);
+  if (counts[index] == UINT16_MAX) {
+    total = 0;
+    for (auto& bucket : counts) {
+      bucket /= 2;
+      total += bucket;
+    }
+  }
+  ++counts[index];
+  ++total;
+  ++count;
+  sum += micros;
+  if (micros > max) {
+    max = micros;
+  }
+}
+
+uint32_t LatencyHistogram::percentile(float fraction) const {
+  if (total == 0) {
+    return 0;
+  }
+  auto rank = (uint32_t) ceilf(fraction * (float) total);
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < bucket_count; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      uint32_t upper = bucket_upper_bound(i);
+      return upper < max ? upper : max;
+    }
+  }
+  return max;
+}
+
+uint32_t LatencyHistogram::get_count() const {
+  return count;
+}
+
+uint32_t LatencyHistogram::get_mean() const {
+  return count ? (uint32_t) (sum / count) : 0;
+}
+
+uint32_t LatencyHistogram::get_max() const {
+  return max;
+}
+
+void LatencyHistogram::reset() {
+  *this = LatencyHistogram();
+}
+
+void LatencyHistogram::dump(Print& out) const {
+  char line[96];
+  int length = snprintf(line, sizeof(line), "n=%lu p50=%luus p95=%luus p99=%luus max=%luus\n",
+                        (unsigned long) count, (unsigned long) percentile(0.5f), (unsigned long) percentile(0.95f),
+                        (unsigned long) percentile(0.99f), (unsigned long) max);
+  if (length > 0) {
+    out.write((const uint8_t*) line, (size_t) length < sizeof(line) ? (size_t) length : sizeof(line) - 1);
+  }
+}
@@ -0,0 +1,181 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "OutputSink.hpp"
+#include <assert.h>
+#include <stdarg.h>
+
+OutputSink::OutputSink(Print& out, OutputSlot* slots, char* text, uint16_t slot_count, uint16_t slot_size)
+    : out(out), slots(slots), text(text), slot_count(slot_count), slot_size(slot_size), enqueue_position(0),
+      dequeue_position(0), records(0), dropped(0), truncated(0), drained(0), drain_task(nullptr),
+      drain_done(nullptr), drain_poll(10), stop_requested(false) {
+  // Positions map to slots with a mask
+  assert(slot_count && (slot_count & (slot_count - 1)) == 0);
+  // A slot is free for the writer at position p when its sequence is p, filled for the reader when it is p + 1
+  for (uint16_t i = 0; i < slot_count; ++i) {
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+    slots[i].length = 0;
+  }
+}
+
+OutputSink::~OutputSink() {
+  stop_drain();
+}
+
+bool OutputSink::claim(uint32_t& position) {
+  position = enqueue_position.load(std::memory_order_relaxed);
+  while (true) {
+    OutputSlot& slot = slots[position & (slot_count - 1)];
+    auto difference = (int32_t) (slot.sequence.load(std::memory_order_acquire) - position);
+    if (difference == 0) {
+      if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        return true;
+      }
+    } else if (difference < 0) {
+      ++dropped;
+      return false;
+    } else {
+      position = enqueue_position.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void OutputSink::publish(uint32_t position, size_t length) {
+  OutputSlot& slot = slots[position & (slot_count - 1)];
+  slot.length = (uint16_t) length;
+  slot.sequence.store(position + 1, std::memory_order_release);
+  ++records;
+}
+
+size_t OutputSink::write(const uint8_t* buffer, size_t length) {
+  size_t written = 0;
+  while (written < length) {
+    uint32_t position;
+    if (!claim(position)) {
+      return written;
+    }
+    size_t chunk = length - written < slot_size ? length - written : slot_size;
+    memcpy(text + (position & (slot_count - 1)) * slot_size, buffer + written, chunk);
+    publish(position, chunk);
+    written += chunk;
+  }
+  return written;
+}
+
+size_t OutputSink::write(uint8_t byte) {
+  return write(&byte, 1);
+}
+
+size_t OutputSink::printf(const char* format, ...) {
+  uint32_t position;
+  if (!claim(position)) {
+    return 0;
+  }
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(text + (position & (slot_count - 1)) * slot_size, slot_size, format, args);
+  va_end(args);
+  if (length < 0) {
+    length = 0;
+  } else if (length >= slot_size) {
+    ++truncated;
+    length = slot_size - 1;
+  }
+  publish(position, (size_t) length);
+  return (size_t) length;
+}
+
+uint32_t OutputSink::drain(uint32_t max_records) {
+  uint32_t count = 0;
+  uint32_t position = dequeue_position.load(std::memory_order_relaxed);
+  while (max_records == 0 || count < max_records) {
+    OutputSlot& slot = slots[position & (slot_count - 1)];
+    auto difference = (int32_t) (slot.sequence.load(std::memory_order_acquire) - (position + 1));
+    if (difference < 0) {
+      break;
+    }
+    if (difference > 0) {
+      position = dequeue_position.load(std::memory_order_relaxed);
+      continue;
+    }
+    if (!dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+      continue;
+    }
+    out.write((const uint8_t*) text + (position & (slot_count - 1)) * slot_size, slot.length);
+    // Free the slot for the writer one lap further
+    slot.sequence.store(position + slot_count, std::memory_order_release);
+    ++position;
+    ++count;
+  }
+  drained += count;
+  return count;
+}
+
+bool OutputSink::start_drain(uint32_t poll_millis, uint8_t priority, uint8_t core, uint32_t memory) {
+  if (drain_task) {
+    return false;
+  }
+  drain_poll = poll_millis ? poll_millis : 1;
+  stop_requested = false;
+  drain_done = xSemaphoreCreateBinary();
+  if (xTaskCreatePinnedToCore(OutputSink::run_drain, "output", memory, this, priority, &drain_task, core) != pdPASS) {
+    drain_task = nullptr;
+    vSemaphoreDelete(drain_done);
+    drain_done = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void OutputSink::stop_drain() {
+  if (!drain_task) {
+    return;
+  }
+  stop_requested = true;
+  xSemaphoreTake(drain_done, portMAX_DELAY);
+  vSemaphoreDelete(drain_done);
+  drain_done = nullptr;
+  drain_task = nullptr;
+}
+
+void OutputSink::run_drain(void* instance) {
+  auto sink = (OutputSink*) instance;
+  while (!sink->stop_requested) {
+    if (sink->drain() == 0) {
+      vTaskDelay(pdMS_TO_TICKS(sink->drain_poll));
+    }
+  }
+  xSemaphoreGive(sink->drain_done);
+  vTaskDelete(nullptr);
+}
+
+uint32_t OutputSink::pending() const {
+  return enqueue_position.load(std::memory_order_relaxed) - dequeue_position.load(std::memory_order_relaxed);
+}
+
+OutputSink::Stats OutputSink::get_stats() const {
+  Stats stats = {records.load(), dropped.load(), truncated.load(), drained.load()};
+  return stats;
+}
+
+CountingOutput::CountingOutput() : bytes(0), writes(0) {
+}
+
+size_t CountingOutput::write(uint8_t byte) {
+  return write(&byte, 1);
+}
+
+size_t CountingOutput::write(const uint8_t* buffer, size_t length) {
+  bytes += length;
+  ++writes;
+  return length;
+}
+
+uint32_t CountingOutput::get_bytes() const {
+  return bytes;
+}
+
+uint32_t CountingOutput::get_writes() const {
+  return writes;
+}
@@ -0,0 +1,167 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "Recorder.hpp"
+
+static const uint8_t recording_magic[4] = {'S', 'R', 'R', 'C'};
+static const uint8_t recording_version = 1;
+
+WorkRecorder::WorkRecorder(Print& output) : Handler(), output(output), last_timestamp(0), record_count(0) {
+}
+
+void WorkRecorder::record_worker(uint8_t worker_id) {
+  filter.push_back(worker_id);
+}
+
+uint32_t WorkRecorder::get_record_count() const {
+  return record_count;
+}
+
+bool WorkRecorder::activate(bool retry) {
+  if (!retry) {
+    output.write(recording_magic, sizeof(recording_magic));
+    output.write(recording_version);
+    last_timestamp = 0;
+  }
+  return true;
+}
+
+void WorkRecorder::write_varint(uint32_t value) {
+  uint8_t bytes[5];
+  uint8_t length = 0;
+  do {
+    bytes[length] = value & 0x7F;
+    value >>= 7;
+    if (value) {
+      bytes[length] |= 0x80;
+    }
+    ++length;
+  } while (value);
+  output.write(bytes, length);
+}
+
+int8_t WorkRecorder::handle_produced_work(const WorkerMap& workers) {
+  bool recorded = false;
+  for (const auto& w : workers) {
+    auto worker = w.second;
+    if (!worker || !worker->is_fresh() || !worker->get_raw_data()) {
+      continue;
+    }
+    if (!filter.empty() && std::find(filter.begin(), filter.end(), w.first) == filter.end()) {
+      continue;
+    }
+    uint32_t timestamp = worker->get_last_produce();
+    output.write(w.first);
+    write_varint(timestamp - last_timestamp);
+    write_varint(worker->get_data_size());
+    output.write((const uint8_t*) worker->get_raw_data(), worker->get_data_size());
+    last_timestamp = timestamp;
+    ++record_count;
+    recorded = true;
+  }
+  return recorded ? e_handler_data_handled : e_handler_idle;
+}
+
+ReplayReader::ReplayReader(Stream& input)
+    : Worker<uint16_t>(0, 0), input(input), driven_clock(nullptr), pending(false), end_of_log(false), pending_id(0),
+      pending_timestamp(0), recorded_time(0), time_offset(0) {
+}
+
+void ReplayReader::drive_clock(VirtualClock& clock) {
+  driven_clock = &clock;
+}
+
+bool ReplayReader::finished() const {
+  return end_of_log && !pending;
+}
+
+bool ReplayReader::take(uint8_t worker_id, void* out, size_t size) {
+  auto slot = slots.find(worker_id);
+  if (slot == slots.end() || !slot->second.fresh || slot->second.bytes.size() != size) {
+    return false;
+  }
+  memcpy(out, slot->second.bytes.data(), size);
+  slot->second.fresh = false;
+  return true;
+}
+
+bool ReplayReader::activate(bool retry) {
+  uint8_t header[sizeof(recording_magic) + 1];
+  if (input.readBytes(header, sizeof(header)) != sizeof(header)
+      || memcmp(header, recording_magic, sizeof(recording_magic)) != 0
+      || header[sizeof(recording_magic)] != recording_version) {
+    return false;
+  }
+  recorded_time = 0;
+  end_of_log = false;
+  pending = read_next();
+  // Map the first record onto the current time
+  time_offset = Clock::get().millis() - (pending ? pending_timestamp : 0);
+  return true;
+}
+
+bool ReplayReader::read_varint(uint32_t& value) {
+  value = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    int byte = input.read();
+    if (byte < 0) {
+      return false;
+    }
+    value |= (uint32_t) (byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReplayReader::read_next() {
+  int id = input.read();
+  uint32_t delta, size;
+  if (id < 0 || !read_varint(delta) || !read_varint(size)) {
+    end_of_log = true;
+    return false;
+  }
+  pending_bytes.resize(size);
+  if (input.readBytes(pending_bytes.data(), size) != size) {
+    end_of_log = true;
+    return false;
+  }
+  pending_id = (uint8_t) id;
+  recorded_time += delta;
+  pending_timestamp = recorded_time;
+  return true;
+}
+
+int8_t ReplayReader::produce_data() {
+  // Released data not taken last tick is dropped
+  for (auto& slot : slots) {
+    slot.second.fresh = false;
+  }
+  uint16_t released = 0;
+  while (pending || (!end_of_log && (pending = read_next()))) {
+    auto& slot = slots[pending_id];
+    if (slot.fresh) {
+      // Keep every sample, release the next record of this worker next tick
+      break;
+    }
+    uint32_t due = pending_timestamp + time_offset;
+    if ((int32_t) (Clock::get().millis() - due) < 0) {
+      if (driven_clock && released == 0) {
+        driven_clock->set_time(due);
+      } else {
+        break;
+      }
+    }
+    slot.bytes.swap(pending_bytes);
+    slot.fresh = true;
+    pending = false;
+    ++released;
+  }
+  if (released) {
+    data = released;
+    return e_worker_data_read;
+  }
+  return e_worker_idle;
+}
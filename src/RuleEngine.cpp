@@ -0,0 +1,293 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "RuleEngine.hpp"
+#include <algorithm>
+#include "Clock.hpp"
+
+static const char* const kind_names[] = {"", "above", "below", "rate", "above_for"};
+
+static const char* skip_spaces(const char* text) {
+  while (*text == ' ' || *text == '\t') {
+    ++text;
+  }
+  return text;
+}
+
+/**
+ * Match the word at the start of text
+ * @return text after the word, nullptr if it does not match
+ */
+static const char* match_word(const char* text, const char* word) {
+  size_t length = strlen(word);
+  if (strncmp(text, word, length) != 0 || (text[length] != '\0' && text[length] != ' ' && text[length] != '\t')) {
+    return nullptr;
+  }
+  return skip_spaces(text + length);
+}
+
+static bool parse_long(const char*& text, long& value) {
+  char* end = nullptr;
+  value = strtol(text, &end, 10);
+  if (end == text) {
+    return false;
+  }
+  text = skip_spaces(end);
+  return true;
+}
+
+static bool parse_float(const char*& text, float& value) {
+  char* end = nullptr;
+  value = strtof(text, &end);
+  if (end == text) {
+    return false;
+  }
+  text = skip_spaces(end);
+  return true;
+}
+
+static bool parse_rule(const char*& text, long& rule) {
+  return parse_long(text, rule) && rule >= 0 && rule < RuleEngine::no_rule;
+}
+
+RuleEngine::RuleEngine()
+    : ProcessWorker<RuleAlerts>(RuleAlerts{nullptr, 0}, 0), rules_mutex(xSemaphoreCreateMutex()), dirty(false),
+      evaluations(0) {
+}
+
+RuleEngine::~RuleEngine() {
+  vSemaphoreDelete(rules_mutex);
+}
+
+void RuleEngine::set_input(uint8_t worker_id, Accessor accessor) {
+  xSemaphoreTake(rules_mutex, portMAX_DELAY);
+  inputs[worker_id] = accessor;
+  dirty = true;
+  xSemaphoreGive(rules_mutex);
+}
+
+uint16_t RuleEngine::add_rule(uint8_t worker_id, Kind kind, float threshold, float hysteresis, uint32_t duration) {
+  if (kind == e_rule_none) {
+    return no_rule;
+  }
+  Rule rule = {worker_id, (uint8_t) kind, true, false, false, false, threshold, hysteresis, duration, 0, 0, 0};
+  uint16_t id = no_rule;
+  xSemaphoreTake(rules_mutex, portMAX_DELAY);
+  for (size_t i = 0; i < rules.size(); ++i) {
+    if (rules[i].kind == e_rule_none) {
+      rules[i] = rule;
+      id = (uint16_t) i;
+      break;
+    }
+  }
+  if (id == no_rule && rules.size() < no_rule) {
+    rules.push_back(rule);
+    id = (uint16_t) (rules.size() - 1);
+  }
+  dirty = dirty || id != no_rule;
+  xSemaphoreGive(rules_mutex);
+  return id;
+}
+
+bool RuleEngine::valid_rule(uint16_t rule) const {
+  return rule < rules.size() && rules[rule].kind != e_rule_none;
+}
+
+bool RuleEngine::remove_rule(uint16_t rule) {
+  xSemaphoreTake(rules_mutex, portMAX_DELAY);
+  bool valid = valid_rule(rule);
+  if (valid) {
+    rules[rule].kind = e_rule_none;
+    rules[rule].alerting = false;
+    dirty = true;
+  }
+  xSemaphoreGive(rules_mutex);
+  return valid;
+}
+
+bool RuleEngine::set_threshold(uint16_t rule, float threshold) {
+  xSemaphoreTake(rules_mutex, portMAX_DELAY);
+  bool valid = valid_rule(rule);
+  if (valid) {
+    rules[rule].threshold = threshold;
+  }
+  xSemaphoreGive(rules_mutex);
+  return valid;
+}
+
+bool RuleEngine::set_rule_enabled(uint16_t rule, bool enabled) {
+  xSemaphoreTake(rules_mutex, portMAX_DELAY);
+  bool valid = valid_rule(rule);
+  if (valid && rules[rule].enabled != enabled) {
+    Rule& target = rules[rule];
+    target.enabled = enabled;
+    target.alerting = false;
+    target.has_last = false;
+    target.above = false;
+    dirty = true;
+  }
+  xSemaphoreGive(rules_mutex);
+  return valid;
+}
+
+uint16_t RuleEngine::execute(const char* text) {
+  text = skip_spaces(text);
+  const char* rest;
+  long rule;
+  if ((rest = match_word(text, "add"))) {
+    long worker_id;
+    float threshold;
+    float hysteresis = 0;
+    long duration = 0;
+    if (!parse_long(rest, worker_id) || worker_id < 0 || worker_id > 0xFF) {
+      return no_rule;
+    }
+    uint8_t kind = e_rule_none;
+    for (uint8_t i = e_rule_above; i <= e_rule_above_for; ++i) {
+      const char* after = match_word(rest, kind_names[i]);
+      if (after) {
+        kind = i;
+        rest = after;
+        break;
+      }
+    }
+    if (kind == e_rule_none || !parse_float(rest, threshold)) {
+      return no_rule;
+    }
+    if (*rest && !parse_float(rest, hysteresis)) {
+      return no_rule;
+    }
+    if (*rest && (!parse_long(rest, duration) || duration < 0)) {
+      return no_rule;
+    }
+    if (*rest) {
+      return no_rule;
+    }
+    return add_rule((uint8_t) worker_id, (Kind) kind, threshold, hysteresis, (uint32_t) duration);
+  }
+
+  bool valid = false;
+  if ((rest = match_word(text, "remove")) && parse_rule(rest, rule) && !*rest) {
+    valid = remove_rule((uint16_t) rule);
+  } else if ((rest = match_word(text, "threshold")) && parse_rule(rest, rule)) {
+    float threshold;
+    valid = parse_float(rest, threshold) && !*rest && set_threshold((uint16_t) rule, threshold);
+  } else if ((rest = match_word(text, "enable")) && parse_rule(rest, rule) && !*rest) {
+    valid = set_rule_enabled((uint16_t) rule, true);
+  } else if ((rest = match_word(text, "disable")) && parse_rule(rest, rule) && !*rest) {
+    valid = set_rule_enabled((uint16_t) rule, false);
+  }
+  return valid ? (uint16_t) rule : no_rule;
+}
+
+bool RuleEngine::is_alerting(uint16_t rule) const {
+  xSemaphoreTake(rules_mutex, portMAX_DELAY);
+  bool alerting = valid_rule(rule) && rules[rule].alerting;
+  xSemaphoreGive(rules_mutex);
+  return alerting;
+}
+
+size_t RuleEngine::get_rule_count() const {
+  xSemaphoreTake(rules_mutex, portMAX_DELAY);
+  size_t count = rules.size();
+  xSemaphoreGive(rules_mutex);
+  return count;
+}
+
+uint32_t RuleEngine::get_evaluations() const {
+  return evaluations;
+}
+
+void RuleEngine::compile() {
+  order.clear();
+  for (size_t i = 0; i < rules.size(); ++i) {
+    if (rules[i].kind != e_rule_none && rules[i].enabled && inputs.count(rules[i].worker_id)) {
+      order.push_back((uint16_t) i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [this](uint16_t a, uint16_t b) {
+    return rules[a].worker_id < rules[b].worker_id;
+  });
+  groups.clear();
+  for (size_t i = 0; i < order.size(); ++i) {
+    uint8_t worker_id = rules[order[i]].worker_id;
+    if (groups.empty() || groups.back().worker_id != worker_id) {
+      groups.push_back(Group{worker_id, inputs[worker_id], (uint16_t) i, 0});
+    }
+    ++groups.back().count;
+  }
+  dirty = false;
+}
+
+void RuleEngine::evaluate(uint16_t index, float value, uint32_t now) {
+  Rule& rule = rules[index];
+  bool raise = false;
+  bool clear = false;
+  float reported = value;
+  switch (rule.kind) {
+    case e_rule_above:
+      raise = value > rule.threshold;
+      clear = value <= rule.threshold - rule.hysteresis;
+      break;
+    case e_rule_below:
+      raise = value < rule.threshold;
+      clear = value >= rule.threshold + rule.hysteresis;
+      break;
+    case e_rule_rate:
+      if (rule.has_last && now != rule.last_time) {
+        reported = (value - rule.last_value) * 1000.0f / (float) (now - rule.last_time);
+        float rate = fabsf(reported);
+        raise = rate > rule.threshold;
+        clear = rate <= rule.threshold - rule.hysteresis;
+      }
+      rule.last_value = value;
+      rule.last_time = now;
+      rule.has_last = true;
+      break;
+    case e_rule_above_for:
+      if (value > rule.threshold) {
+        if (!rule.above) {
+          rule.above = true;
+          rule.above_since = now;
+        }
+        raise = now - rule.above_since >= rule.duration;
+      } else {
+        rule.above = false;
+      }
+      clear = value <= rule.threshold - rule.hysteresis;
+      break;
+    default:
+      return;
+  }
+  ++evaluations;
+  if (!rule.alerting && raise) {
+    rule.alerting = true;
+    transitions.push_back(RuleAlert{index, rule.worker_id, true, reported});
+  } else if (rule.alerting && clear) {
+    rule.alerting = false;
+    transitions.push_back(RuleAlert{index, rule.worker_id, false, reported});
+  }
+}
+
+int8_t RuleEngine::produce_data(const WorkerMap& workers) {
+  xSemaphoreTake(rules_mutex, portMAX_DELAY);
+  if (dirty) {
+    compile();
+  }
+  transitions.clear();
+  uint32_t now = Clock::get().millis();
+  for (const auto& group : groups) {
+    auto found = workers.find(group.worker_id);
+    if (found == workers.end() || !found->second->is_fresh()) {
+      continue;
+    }
+    float value = group.accessor(*found->second);
+    for (uint16_t i = group.first; i < group.first + group.count; ++i) {
+      evaluate(order[i], value, now);
+    }
+  }
+  xSemaphoreGive(rules_mutex);
+  data = RuleAlerts{transitions.data(), transitions.size()};
+  return transitions.empty() ? e_worker_idle : e_worker_data_read;
+}
@@ -0,0 +1,101 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "TickSnapshot.hpp"
+
+TickSnapshot::TickSnapshot() : sequence(0) {
+}
+
+void TickSnapshot::layout(const WorkerMap& workers) {
+  entries.clear();
+  size_t offset = 0;
+  for (const auto& w : workers) {
+    if (!w.second) {
+      continue;
+    }
+    size_t size = w.second->get_raw_data() ? w.second->get_data_size() : 0;
+    entries.push_back(Entry{w.first, BaseWorker::e_worker_idle, false, 0, 0, offset, size});
+    offset += (size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+  }
+  storage.assign(offset / sizeof(uint64_t), 0);
+}
+
+void TickSnapshot::capture(const WorkerMap& workers, uint32_t _sequence) {
+  size_t count = 0;
+  for (const auto& w : workers) {
+    if (w.second) {
+      ++count;
+    }
+  }
+  if (count != entries.size()) {
+    layout(workers);
+  }
+  auto bytes = (uint8_t*) storage.data();
+  for (auto& entry : entries) {
+    auto worker = workers.at(entry.id);
+    entry.status = worker->get_status();
+    entry.fresh = worker->is_fresh();
+    entry.last_produce = worker->get_last_produce();
+    entry.produce_micros = worker->get_produce_micros();
+    if (entry.size) {
+      memcpy(bytes + entry.offset, worker->get_raw_data(), entry.size);
+    }
+  }
+  sequence = _sequence;
+}
+
+uint32_t TickSnapshot::get_sequence() const {
+  return sequence;
+}
+
+const TickSnapshot::Entry* TickSnapshot::find(uint8_t worker_id) const {
+  // Entries are sorted by id, like the worker map
+  auto entry = std::lower_bound(
+      entries.begin(),
+      entries.end(),
+      worker_id,
+      [](const Entry& e, uint8_t id) { return e.id < id; }
+  );
+  return entry != entries.end() && entry->id == worker_id ? &*entry : nullptr;
+}
+
+bool TickSnapshot::contains(uint8_t worker_id) const {
+  return find(worker_id) != nullptr;
+}
+
+int8_t TickSnapshot::get_status(uint8_t worker_id) const {
+  auto entry = find(worker_id);
+  return entry ? entry->status : (int8_t) BaseWorker::e_worker_idle;
+}
+
+bool TickSnapshot::is_fresh(uint8_t worker_id) const {
+  auto entry = find(worker_id);
+  return entry && entry->fresh;
+}
+
+uint32_t TickSnapshot::get_last_produce(uint8_t worker_id) const {
+  auto entry = find(worker_id);
+  return entry ? entry->last_produce : 0;
+}
+
+uint32_t TickSnapshot::get_produce_micros(uint8_t worker_id) const {
+  auto entry = find(worker_id);
+  return entry ? entry->produce_micros : 0;
+}
+
+size_t TickSnapshot::get_worker_count() const {
+  return entries.size();
+}
+
+uint8_t TickSnapshot::get_worker_id(size_t index) const {
+  return entries[index].id;
+}
+
+bool TickSnapshot::any_updates() const {
+  return std::any_of(
+      entries.begin(),
+      entries.end(),
+      [](const Entry& entry) { return entry.status != BaseWorker::e_worker_idle; }
+  );
+}
@@ -0,0 +1,289 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "TimeSeries.hpp"
+
+namespace {
+
+uint32_t float_bits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+float bits_float(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+uint64_t zigzag(int64_t value) {
+  return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+  return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+/**
+ * Delta of delta buckets: prefix of `prefix_bits` ones (terminated by a zero, except the last bucket) and a
+ * zigzag value of `value_bits`. Larger values fall through to a varint.
+ */
+struct Bucket {
+  uint8_t prefix;
+  uint8_t prefix_bits;
+  uint8_t value_bits;
+};
+
+const Bucket buckets[] = {
+    {0x2, 2, 7}, // 10
+    {0x6, 3, 9}, // 110
+    {0xE, 4, 12}, // 1110
+};
+const uint8_t varint_prefix = 0xF; // 1111
+const uint8_t varint_prefix_bits = 4;
+
+} // namespace
+
+BitWriter::BitWriter(uint8_t* buffer, size_t capacity) : buffer(buffer), capacity(capacity), position(0) {
+}
+
+bool BitWriter::write(uint32_t bits, uint8_t count) {
+  if (count > capacity * 8 - position) {
+    return false;
+  }
+  while (count) {
+    uint8_t used = position & 7;
+    uint8_t space = 8 - used;
+    uint8_t take = count < space ? count : space;
+    uint8_t chunk = (bits >> (count - take)) & ((1u << take) - 1);
+    if (used == 0) {
+      buffer[position >> 3] = 0;
+    }
+    buffer[position >> 3] |= chunk << (space - take);
+    position += take;
+    count -= take;
+  }
+  return true;
+}
+
+bool BitWriter::write_varint(uint64_t value) {
+  while (value >= 0x80) {
+    if (!write((uint32_t) (value & 0x7F) | 0x80, 8)) {
+      return false;
+    }
+    value >>= 7;
+  }
+  return write((uint32_t) value, 8);
+}
+
+void BitWriter::rewind(size_t _position) {
+  position = _position;
+  if (position & 7) {
+    // Clear the dropped bits, the next write ORs into this byte
+    buffer[position >> 3] &= (uint8_t) (0xFF << (8 - (position & 7)));
+  }
+}
+
+size_t BitWriter::get_position() const {
+  return position;
+}
+
+size_t BitWriter::size() const {
+  return (position + 7) / 8;
+}
+
+BitReader::BitReader(const uint8_t* buffer, size_t length)
+    : buffer(buffer), length(length), position(0), error(false) {
+}
+
+uint32_t BitReader::read(uint8_t count) {
+  if (count > length * 8 - position) {
+    error = true;
+    position = length * 8;
+    return 0;
+  }
+  uint32_t bits = 0;
+  while (count) {
+    uint8_t used = position & 7;
+    uint8_t space = 8 - used;
+    uint8_t take = count < space ? count : space;
+    uint8_t chunk = (buffer[position >> 3] >> (space - take)) & ((1u << take) - 1);
+    bits = (bits << take) | chunk;
+    position += take;
+    count -= take;
+  }
+  return bits;
+}
+
+uint64_t BitReader::read_varint() {
+  uint64_t value = 0;
+  for (uint8_t shift = 0; shift < 64; shift += 7) {
+    uint32_t byte = read(8);
+    value |= (uint64_t) (byte & 0x7F) << shift;
+    if (!(byte & 0x80) || error) {
+      return value;
+    }
+  }
+  error = true;
+  return value;
+}
+
+bool BitReader::failed() const {
+  return error;
+}
+
+TimeSeriesEncoder::TimeSeriesEncoder(uint8_t* buffer, size_t capacity)
+    : buffer(buffer), writer(buffer, capacity), count(0), previous_timestamp(0), previous_delta(0), previous_value(0),
+      previous_leading(0), previous_trailing(0) {
+}
+
+bool TimeSeriesEncoder::append(uint32_t timestamp, float value) {
+  if (count == UINT16_MAX) {
+    return false;
+  }
+  size_t start = writer.get_position();
+  uint32_t bits = float_bits(value);
+  bool written;
+  if (count == 0) {
+    written = writer.write_varint(timestamp) && writer.write(bits, 32);
+  } else {
+    // Keep the state untouched until the whole sample fits
+    int32_t delta = previous_delta;
+    uint8_t leading = previous_leading;
+    uint8_t trailing = previous_trailing;
+    written = write_timestamp(timestamp) && write_value(bits);
+    if (!written) {
+      previous_delta = delta;
+      previous_leading = leading;
+      previous_trailing = trailing;
+    }
+  }
+  if (!written) {
+    writer.rewind(start);
+    return false;
+  }
+  previous_timestamp = timestamp;
+  previous_value = bits;
+  ++count;
+  return true;
+}
+
+bool TimeSeriesEncoder::write_timestamp(uint32_t timestamp) {
+  auto delta = (int32_t) (timestamp - previous_timestamp);
+  int64_t delta_of_delta = (int64_t) delta - previous_delta;
+  previous_delta = delta;
+  if (delta_of_delta == 0) {
+    return writer.write(0, 1);
+  }
+  uint64_t encoded = zigzag(delta_of_delta);
+  for (const Bucket& bucket : buckets) {
+    if (encoded < (1ull << bucket.value_bits)) {
+      return writer.write(bucket.prefix, bucket.prefix_bits) && writer.write((uint32_t) encoded, bucket.value_bits);
+    }
+  }
+  return writer.write(varint_prefix, varint_prefix_bits) && writer.write_varint(encoded);
+}
+
+bool TimeSeriesEncoder::write_value(uint32_t bits) {
+  uint32_t xored = bits ^ previous_value;
+  if (xored == 0) {
+    return writer.write(0, 1);
+  }
+  auto leading = (uint8_t) __builtin_clz(xored);
+  auto trailing = (uint8_t) __builtin_ctz(xored);
+  if (count > 1 && leading >= previous_leading && trailing >= previous_trailing) {
+    // Changed bits fit in the window of the previous value
+    uint8_t meaningful = 32 - previous_leading - previous_trailing;
+    return writer.write(0x2, 2) && writer.write(xored >> previous_trailing, meaningful);
+  }
+  uint8_t meaningful = 32 - leading - trailing;
+  previous_leading = leading;
+  previous_trailing = trailing;
+  // Leading zeros in 5 bits (xored is not 0, so at most 31), meaningful bits - 1 in 5 bits
+  return writer.write(0x3, 2) && writer.write(leading, 5) && writer.write(meaningful - 1, 5)
+      && writer.write(xored >> trailing, meaningful);
+}
+
+void TimeSeriesEncoder::reset() {
+  writer.rewind(0);
+  count = 0;
+  previous_timestamp = 0;
+  previous_delta = 0;
+  previous_value = 0;
+  previous_leading = 0;
+  previous_trailing = 0;
+}
+
+uint16_t TimeSeriesEncoder::get_count() const {
+  return count;
+}
+
+const uint8_t* TimeSeriesEncoder::data() const {
+  return buffer;
+}
+
+size_t TimeSeriesEncoder::size() const {
+  return writer.size();
+}
+
+TimeSeriesDecoder::TimeSeriesDecoder(const uint8_t* buffer, size_t length, uint16_t count)
+    : reader(buffer, length), remaining(count), decoded(0), previous_timestamp(0), previous_delta(0),
+      previous_value(0), previous_leading(0), previous_trailing(0), corrupt(false) {
+}
+
+bool TimeSeriesDecoder::next(uint32_t& timestamp, float& value) {
+  if (remaining == 0 || failed()) {
+    return false;
+  }
+  if (decoded == 0) {
+    previous_timestamp = (uint32_t) reader.read_varint();
+    previous_value = reader.read(32);
+  } else {
+    // Timestamp
+    int64_t delta_of_delta = 0;
+    if (reader.read(1)) {
+      uint8_t prefix = 0x1;
+      const Bucket* match = nullptr;
+      for (const Bucket& bucket : buckets) {
+        prefix = (prefix << 1) | reader.read(1);
+        if (prefix == bucket.prefix) {
+          match = &bucket;
+          break;
+        }
+      }
+      uint64_t encoded = match ? reader.read(match->value_bits) : reader.read_varint();
+      delta_of_delta = unzigzag(encoded);
+    }
+    previous_delta = (int32_t) (previous_delta + delta_of_delta);
+    previous_timestamp += previous_delta;
+
+    // Value
+    if (reader.read(1)) {
+      if (reader.read(1)) {
+        previous_leading = reader.read(5);
+        uint8_t meaningful = reader.read(5) + 1;
+        if (previous_leading + meaningful > 32) {
+          corrupt = true;
+          return false;
+        }
+        previous_trailing = 32 - previous_leading - meaningful;
+      }
+      uint8_t meaningful = 32 - previous_leading - previous_trailing;
+      previous_value ^= reader.read(meaningful) << previous_trailing;
+    }
+  }
+  if (reader.failed()) {
+    return false;
+  }
+  ++decoded;
+  --remaining;
+  timestamp = previous_timestamp;
+  value = bits_float(previous_value);
+  return true;
+}
+
+bool TimeSeriesDecoder::failed() const {
+  return corrupt || reader.failed();
+}
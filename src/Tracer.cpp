@@ -0,0 +1,86 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "Tracer.hpp"
+
+#ifdef SENSOR_REPORTER_TRACE
+
+Tracer::Event Tracer::events[SENSOR_REPORTER_TRACE_CAPACITY];
+std::atomic<uint32_t> Tracer::head(0);
+std::atomic<bool> Tracer::enabled(true);
+std::atomic<uint32_t> Tracer::writers(0);
+
+void Tracer::record(Phase phase, Component component, Stage stage, uint8_t id) {
+  // Announce the write before checking enabled, so dump either sees the writer or the writer sees it disabled
+  writers.fetch_add(1);
+  if (!enabled.load()) {
+    writers.fetch_sub(1);
+    return;
+  }
+  uint32_t idx = head.fetch_add(1, std::memory_order_relaxed) % SENSOR_REPORTER_TRACE_CAPACITY;
+  auto& event = events[idx];
+  event.timestamp = micros();
+  event.phase_core = (uint8_t) ((phase << 7) | (xPortGetCoreID() & 0x7F));
+  event.component = component;
+  event.stage = stage;
+  event.id = id;
+  writers.fetch_sub(1);
+}
+
+void Tracer::set_enabled(bool _enabled) {
+  enabled.store(_enabled);
+}
+
+void Tracer::clear() {
+  head.store(0);
+}
+
+static void write_u16(Print& out, uint16_t value) {
+  uint8_t bytes[2] = {(uint8_t) value, (uint8_t) (value >> 8)};
+  out.write(bytes, sizeof(bytes));
+}
+
+static void write_u32(Print& out, uint32_t value) {
+  uint8_t bytes[4] = {(uint8_t) value, (uint8_t) (value >> 8), (uint8_t) (value >> 16), (uint8_t) (value >> 24)};
+  out.write(bytes, sizeof(bytes));
+}
+
+void Tracer::dump(Print& out) {
+  bool was_enabled = enabled.exchange(false);
+  while (writers.load() != 0) {
+    // A writer (maybe preempted, maybe on the other core) is still filling in its event
+    vTaskDelay(1);
+  }
+  uint32_t total = head.load();
+  uint32_t count = total < SENSOR_REPORTER_TRACE_CAPACITY ? total : SENSOR_REPORTER_TRACE_CAPACITY;
+  uint32_t first = total - count;
+
+  out.write((const uint8_t*) "SRTR", 4);
+  uint8_t info[2] = {1, sizeof(Event)};
+  out.write(info, sizeof(info));
+  write_u16(out, (uint16_t) count);
+  write_u32(out, first);
+  for (uint32_t i = first; i < total; ++i) {
+    const auto& event = events[i % SENSOR_REPORTER_TRACE_CAPACITY];
+    write_u32(out, event.timestamp);
+    uint8_t rest[4] = {event.phase_core, event.component, event.stage, event.id};
+    out.write(rest, sizeof(rest));
+  }
+  out.flush();
+  enabled.store(was_enabled);
+}
+
+#else
+
+// Tracing not compiled in, keep the API available without reserving the ring buffer
+
+void Tracer::record(Phase phase, Component component, Stage stage, uint8_t id) {}
+
+void Tracer::set_enabled(bool _enabled) {}
+
+void Tracer::clear() {}
+
+void Tracer::dump(Print& out) {}
+
+#endif
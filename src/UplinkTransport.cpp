@@ -0,0 +1,104 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "UplinkTransport.hpp"
+
+ClientTransport::ClientTransport(Client& client, const char* host, uint16_t port)
+    : UplinkTransport(), client(client), host(host), port(port) {
+}
+
+bool ClientTransport::connect() {
+  return client.connect(host, port) == 1;
+}
+
+bool ClientTransport::connected() {
+  return client.connected();
+}
+
+size_t ClientTransport::write(const uint8_t* buffer, size_t length) {
+  return client.write(buffer, length);
+}
+
+int ClientTransport::available() {
+  return client.available();
+}
+
+size_t ClientTransport::read(uint8_t* buffer, size_t length) {
+  int result = client.read(buffer, length);
+  return result > 0 ? (size_t) result : 0;
+}
+
+void ClientTransport::close() {
+  client.stop();
+}
+
+LoopbackTransport::LoopbackTransport()
+    : UplinkTransport(), read_position(0), reachable(true), open(false), connects(0) {
+}
+
+bool LoopbackTransport::connect() {
+  if (!reachable) {
+    return false;
+  }
+  open = true;
+  ++connects;
+  return true;
+}
+
+bool LoopbackTransport::connected() {
+  return open;
+}
+
+size_t LoopbackTransport::write(const uint8_t* buffer, size_t length) {
+  if (!open) {
+    return 0;
+  }
+  written.insert(written.end(), buffer, buffer + length);
+  return length;
+}
+
+int LoopbackTransport::available() {
+  return open ? (int) (incoming.size() - read_position) : 0;
+}
+
+size_t LoopbackTransport::read(uint8_t* buffer, size_t length) {
+  size_t count = std::min(length, (size_t) available());
+  memcpy(buffer, incoming.data() + read_position, count);
+  read_position += count;
+  if (read_position == incoming.size()) {
+    incoming.clear();
+    read_position = 0;
+  }
+  return count;
+}
+
+void LoopbackTransport::close() {
+  drop();
+}
+
+void LoopbackTransport::respond(const char* data) {
+  incoming.insert(incoming.end(), data, data + strlen(data));
+}
+
+void LoopbackTransport::set_reachable(bool _reachable) {
+  reachable = _reachable;
+}
+
+void LoopbackTransport::drop() {
+  open = false;
+  incoming.clear();
+  read_position = 0;
+}
+
+const std::vector<uint8_t>& LoopbackTransport::get_written() const {
+  return written;
+}
+
+void LoopbackTransport::clear_written() {
+  written.clear();
+}
+
+uint32_t LoopbackTransport::get_connects() const {
+  return connects;
+}
@@ -3,9 +3,14 @@
 //
 
 #include "Worker.hpp"
+#include "Tracer.hpp"
+#include "Clock.hpp"
 
 BaseWorker::BaseWorker(uint32_t break_duration)
-    : Activatable(), break_duration(break_duration), last_produce(0), status(Status::e_worker_idle), async_result_status(Status::e_worker_idle) {
+    : Activatable(), id(0), break_duration(break_duration), schedule(e_schedule_break), catch_up(e_catch_up_skip),
+      missed_slots(0), late_slots(0), phase(0), grid(1), next_due(0), schedule_started(false), last_produce(0),
+      last_rejected(0), produce_micros(0), produce_count(0), status(Status::e_worker_idle), async_result_status(Status::e_worker_idle),
+      xAsyncWorkerHandle(nullptr), task_core(0), task_started(0) {
 }
 
 int8_t BaseWorker::get_status() const {
@@ -16,6 +21,26 @@ uint32_t BaseWorker::get_last_produce() const {
   return last_produce;
 }
 
+uint32_t BaseWorker::get_produce_micros() const {
+  return produce_micros;
+}
+
+uint8_t BaseWorker::get_id() const {
+  return id;
+}
+
+uint32_t BaseWorker::get_produce_count() const {
+  return produce_count;
+}
+
+const void* BaseWorker::get_raw_data() const {
+  return nullptr;
+}
+
+size_t BaseWorker::get_data_size() const {
+  return 0;
+}
+
 bool BaseWorker::is_fresh() const {
   return get_active_state() == e_state_active && status == e_worker_data_read;
 }
@@ -25,6 +50,7 @@ int8_t BaseWorker::produce_async_data() {
 }
 
 bool BaseWorker::work(const worker_map_t& workers) {
+  SR_TRACE_SCOPE(Tracer::e_trace_worker, Tracer::e_trace_work, id);
   if (get_active_state() == e_state_activating_failed) {
     // Still activating, will try to activate again
     set_active(true);
@@ -34,40 +60,174 @@ bool BaseWorker::work(const worker_map_t& workers) {
       // Task running async, skip working
       return false;
     } else if (status == e_worker_processing) {
-      // Task completed async, prepare data to be used in system
-      status = async_result_status;
+      int8_t result = resume_async();
+      if (result == e_worker_processing) {
+        // Still suspended
+        return false;
+      }
+      // Completed async, prepare data to be used in system
+      status = result;
+      record_outcome(status);
       async_result_status = e_worker_idle;
+      SR_TRACE_SCOPE(Tracer::e_trace_worker, Tracer::e_trace_finish, id);
       finish_produced_data();
     } else {
       // Normal work process
-      if ((millis() - last_produce > break_duration || last_produce == 0)) {
-        status = is_process_worker() ? produce_data(workers) : produce_data();
-      }
-      else {
-        status = e_worker_idle;
+      uint32_t now = Clock::get().millis();
+      status = e_worker_idle;
+      if (is_due(now)) {
+        if (breaker_allows()) {
+          last_rejected = 0;
+          status = is_process_worker() ? produce_data(workers) : produce_data();
+          record_outcome(status);
+        } else {
+          // Counts as a break, so an open circuit is not asked again every run
+          last_rejected = now;
+        }
       }
     }
     if (is_fresh()) {
       // Work has been produced
-      last_produce = millis();
+      last_produce = Clock::get().millis();
+      produce_micros = Clock::get().micros();
+      ++produce_count;
       return true;
     }
   }
   return false;
 }
 
+void BaseWorker::set_aligned_schedule(uint32_t period, uint32_t _phase) {
+  break_duration = period ? period : 1;
+  phase = _phase % break_duration;
+  schedule = e_schedule_aligned;
+  schedule_started = false;
+}
+
+void BaseWorker::set_fixed_rate_schedule(uint32_t period, CatchUp _catch_up) {
+  break_duration = period ? period : 1;
+  catch_up = _catch_up;
+  schedule = e_schedule_fixed_rate;
+  schedule_started = false;
+}
+
+BaseWorker::Schedule BaseWorker::get_schedule() const {
+  return schedule;
+}
+
+uint32_t BaseWorker::get_missed_slots() const {
+  return missed_slots;
+}
+
+uint32_t BaseWorker::get_late_slots() const {
+  return late_slots;
+}
+
+uint32_t BaseWorker::get_next_due() const {
+  if (schedule == e_schedule_break) {
+    uint32_t last = last_break_start();
+    return break_duration == 0 || last == 0 ? Clock::get().millis() : last + break_duration + 1;
+  }
+  if (schedule_started) {
+    return next_due;
+  }
+  return schedule == e_schedule_fixed_rate ? Clock::get().millis() : next_aligned_slot(Clock::get().millis());
+}
+
+uint32_t BaseWorker::next_aligned_slot(uint32_t now) const {
+  uint32_t slot = now < phase ? phase : now - (now - phase) % break_duration + break_duration;
+  if (grid > 1) {
+    slot = (slot + grid - 1) / grid * grid;
+  }
+  return slot;
+}
+
+bool BaseWorker::wants_to_run(uint32_t now) const {
+  if (!active()) {
+    return get_active_state() == e_state_activating_failed;
+  }
+  if (task_running()) {
+    return false;
+  }
+  return status == e_worker_processing || (int32_t) (now - get_next_due()) >= 0;
+}
+
+bool BaseWorker::is_due(uint32_t now) {
+  switch (schedule) {
+    case e_schedule_aligned:
+      if (!schedule_started) {
+        // Wait for the first slot, so all aligned workers start together
+        next_due = next_aligned_slot(now);
+        schedule_started = true;
+      }
+      if ((int32_t) (now - next_due) < 0) {
+        return false;
+      }
+      next_due = next_aligned_slot(now);
+      return true;
+    case e_schedule_fixed_rate: {
+      if (!schedule_started) {
+        // First produce right away, the following ones every period from here
+        next_due = now;
+        schedule_started = true;
+      }
+      if ((int32_t) (now - next_due) < 0) {
+        return false;
+      }
+      uint32_t missed = (now - next_due) / break_duration;
+      if (missed == 0) {
+        next_due += break_duration;
+        return true;
+      }
+      switch (catch_up) {
+        case e_catch_up_burst:
+          ++late_slots;
+          next_due += break_duration;
+          return true;
+        case e_catch_up_coalesce:
+          ++late_slots;
+          missed_slots += missed;
+          next_due += (missed + 1) * break_duration;
+          return true;
+        default:
+          missed_slots += missed + 1;
+          next_due += (missed + 1) * break_duration;
+          return false;
+      }
+    }
+    default: {
+      uint32_t last = last_break_start();
+      return break_duration == 0 || last == 0 || now - last > break_duration;
+    }
+  }
+}
+
+uint32_t BaseWorker::last_break_start() const {
+  return last_rejected && (last_produce == 0 || (int32_t) (last_rejected - last_produce) > 0) ? last_rejected : last_produce;
+}
+
 int8_t BaseWorker::start_task(const char* task_name, uint32_t memory, uint8_t priority, uint8_t core) {
   if (xAsyncWorkerHandle != nullptr) {
     return e_worker_processing; // Already working
   }
-  xTaskCreatePinnedToCore(BaseWorker::run_task, task_name, memory, this, priority, &xAsyncWorkerHandle, core);
+  task_core = CorePlacement::place(core);
+  task_started = micros();
+  if (xTaskCreatePinnedToCore(BaseWorker::run_task, task_name, memory, this, priority, &xAsyncWorkerHandle, task_core) != pdPASS) {
+    CorePlacement::finish(task_core, 0);
+  }
   return e_worker_processing;
 }
 
+int8_t BaseWorker::resume_async() {
+  return async_result_status;
+}
+
 void BaseWorker::kill_task() {
-  if (xAsyncWorkerHandle != nullptr) {
-    vTaskDelete(xAsyncWorkerHandle);
-    xAsyncWorkerHandle = nullptr;
+  TaskHandle_t handle = xAsyncWorkerHandle;
+  // Claim the handle, so only one of kill_task and run_task counts the task as finished
+  if (handle != nullptr && __sync_bool_compare_and_swap(&xAsyncWorkerHandle, handle, nullptr)) {
+    vTaskDelete(handle);
+    CorePlacement::finish(task_core, micros() - task_started);
   }
 }
 
@@ -77,8 +237,15 @@ bool BaseWorker::task_running() const {
 
 void BaseWorker::run_task(void* instance) {
   auto worker = (BaseWorker*) instance;
-  worker->async_result_status = worker->produce_async_data();
-  worker->xAsyncWorkerHandle = nullptr;
+  {
+    SR_TRACE_SCOPE(Tracer::e_trace_worker, Tracer::e_trace_task, worker->id);
+    worker->async_result_status = worker->produce_async_data();
+  }
+  if (!__sync_bool_compare_and_swap(&worker->xAsyncWorkerHandle, xTaskGetCurrentTaskHandle(), nullptr)) {
+    vTaskSuspend(nullptr); // kill_task claimed the handle and deletes this task
+    return;
+  }
+  CorePlacement::finish(worker->task_core, micros() - worker->task_started);
   vTaskDelete(nullptr);
 }
 
@@ -94,3 +261,12 @@ bool WorkerMap::any_updates() const {
       }
   );
 }
+
+const uint8_t* WorkerMap::encode(uint8_t worker_id, uint8_t format, EncodingCache::Encoder encoder, size_t& length) const {
+  length = 0;
+  auto worker = find(worker_id);
+  if (worker == end() || !worker->second || !encoding_cache) {
+    return nullptr;
+  }
+  return encoding_cache->encode(*worker->second, format, encoder, length);
+}
@@ -0,0 +1,148 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "Arena.hpp"
+#include "Check.hpp"
+
+/*
+ * Exhaustion of the arena, the block pool and the arena worker: failing allocations return nothing, are counted and
+ * leave the memory that was handed out intact.
+ */
+
+static void test_arena_exhaustion() {
+  BumpArena<64> arena;
+  CHECK(arena.allocate(40, 8) != nullptr);
+  CHECK(arena.allocate(24, 8) != nullptr);
+  CHECK_EQUAL(0, arena.remaining());
+  CHECK(arena.allocate(1, 1) == nullptr);
+  CHECK(arena.allocate_span<uint32_t>(1).empty());
+  CHECK(arena.copy("x").empty());
+  CHECK(arena.printf("%d", 1).empty());
+  CHECK_EQUAL(4, arena.get_failed_allocations());
+  CHECK_EQUAL(64, arena.used());
+
+  arena.reset();
+  CHECK_EQUAL(64, arena.remaining());
+  CHECK_EQUAL(64, arena.get_high_water());
+  CHECK(arena.allocate(64, 1) != nullptr);
+}
+
+static void test_arena_alignment_padding() {
+  BumpArena<32> arena;
+  CHECK(arena.allocate(1, 1) != nullptr);
+  // 31 bytes are left, but aligned to 16 only 16 of them can be used
+  CHECK(arena.allocate(17, 16) == nullptr);
+  void* aligned = arena.allocate(16, 16);
+  CHECK(aligned != nullptr && (uintptr_t) aligned % 16 == 0);
+  CHECK_EQUAL(1, arena.get_failed_allocations());
+}
+
+static void test_arena_exact_fit() {
+  BumpArena<8> arena;
+  // printf needs the length plus the terminator
+  Span<char> text = arena.printf("%s", "1234567");
+  CHECK_EQUAL(7, text.size());
+  CHECK(strcmp(text.data, "1234567") == 0);
+  CHECK_EQUAL(0, arena.remaining());
+
+  arena.reset();
+  CHECK(arena.printf("%s", "12345678").empty());
+  CHECK(arena.copy("12345678").empty());
+  CHECK_EQUAL(8, arena.copy((const uint8_t*) "12345678", 8).size());
+  CHECK_EQUAL(2, arena.get_failed_allocations());
+}
+
+static void test_block_pool_exhaustion() {
+  FixedBlockPool<24, 3> pool;
+  void* blocks[3];
+  for (auto& block : blocks) {
+    block = pool.acquire();
+    CHECK(block != nullptr && pool.owns(block));
+  }
+  CHECK_EQUAL(0, pool.available());
+  CHECK(pool.acquire() == nullptr);
+  CHECK_EQUAL(1, pool.get_failed_acquires());
+
+  pool.release(blocks[1]);
+  CHECK_EQUAL(1, pool.available());
+  CHECK(pool.acquire() == blocks[1]);
+  CHECK(pool.acquire() == nullptr);
+  CHECK_EQUAL(2, pool.get_failed_acquires());
+}
+
+struct Reading {
+  Span<char> text;
+  Span<char> note; // Only set by some produces
+  uint32_t count;
+};
+
+class TextWorker : public ArenaWorker<Reading, 16> {
+ public:
+  TextWorker() : ArenaWorker<Reading, 16>(Reading{Span<char>(), Span<char>(), 0}) {
+  }
+
+  const char* next_text;
+  const char* next_note = nullptr;
+
+  int8_t produce() {
+    return produce_data();
+  }
+
+ protected:
+  int8_t produce_arena_data(Reading& next, Arena& arena) override {
+    next.text = arena.copy(next_text);
+    if (next_note) {
+      next.note = arena.copy(next_note);
+    }
+    if (next.text.empty()) {
+      return e_worker_error;
+    }
+    next.count = get_data().count + 1;
+    return e_worker_data_read;
+  }
+};
+
+static void test_arena_worker_exhaustion() {
+  TextWorker worker;
+  worker.next_text = "first";
+  CHECK_EQUAL(BaseWorker::e_worker_data_read, worker.produce());
+  Span<char> first = worker.get_data().text;
+
+  // Does not fit: the current data is kept
+  worker.next_text = "much too long for the arena";
+  CHECK_EQUAL(BaseWorker::e_worker_error, worker.produce());
+  CHECK_EQUAL(1, worker.get_data().count);
+  CHECK(strcmp(worker.get_data().text.data, "first") == 0);
+
+  // The replaced data stays valid until the worker produces again
+  worker.next_text = "second";
+  CHECK_EQUAL(BaseWorker::e_worker_data_read, worker.produce());
+  CHECK(strcmp(first.data, "first") == 0);
+  CHECK(strcmp(worker.get_data().text.data, "second") == 0);
+  CHECK_EQUAL(2, worker.get_data().count);
+}
+
+static void test_arena_worker_unset_span() {
+  TextWorker worker;
+  worker.next_text = "a";
+  worker.next_note = "note";
+  CHECK_EQUAL(BaseWorker::e_worker_data_read, worker.produce());
+  CHECK(strcmp(worker.get_data().note.data, "note") == 0);
+
+  // A span the produce does not set is empty, not a span into the arena that was reset
+  worker.next_note = nullptr;
+  CHECK_EQUAL(BaseWorker::e_worker_data_read, worker.produce());
+  CHECK(worker.get_data().note.empty());
+  CHECK_EQUAL(2, worker.get_data().count);
+}
+
+int main() {
+  test_arena_exhaustion();
+  test_arena_alignment_padding();
+  test_arena_exact_fit();
+  test_block_pool_exhaustion();
+  test_arena_worker_exhaustion();
+  test_arena_worker_unset_span();
+  return check_result();
+}
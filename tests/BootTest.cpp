@@ -0,0 +1,108 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include <atomic>
+#include "Aggregator.hpp"
+#include "Check.hpp"
+
+/*
+ * Boot of workers on tasks: time to the first report with concurrent boot against initializing and activating one
+ * after another, and a timed out boot task that outlives the boot.
+ */
+
+/**
+ * Worker with a slow start, like a sensor warming up or a connection
+ */
+class SlowStartWorker : public Worker<int> {
+ public:
+  explicit SlowStartWorker(uint32_t start_millis = 20) : Worker<int>(0, 0), start_millis(start_millis), started(false) {
+  }
+
+  void initialize() override {
+    delay(start_millis / 2);
+  }
+
+  std::atomic<bool> started;
+
+ protected:
+  bool activate(bool retry) override {
+    delay(start_millis - start_millis / 2);
+    started = true;
+    return true;
+  }
+
+  int8_t produce_data() override {
+    ++data;
+    return e_worker_data_read;
+  }
+
+ private:
+  uint32_t start_millis;
+};
+
+static const uint8_t worker_count = 6;
+
+/**
+ * Run until the first worker is fresh
+ * @return millis since start
+ */
+static uint32_t first_report(Aggregator& aggregator, SlowStartWorker* workers, uint32_t start) {
+  do {
+    aggregator.run();
+  } while (!workers[0].is_fresh());
+  return millis() - start;
+}
+
+static void test_time_to_first_report() {
+  uint32_t sequential;
+  {
+    SlowStartWorker workers[worker_count];
+    Aggregator aggregator;
+    uint32_t start = millis();
+    for (uint8_t i = 0; i < worker_count; ++i) {
+      aggregator.register_worker(i + 1, workers[i]);
+      aggregator.set_worker_active(i + 1, true);
+    }
+    sequential = first_report(aggregator, workers, start);
+  }
+
+  uint32_t concurrent;
+  {
+    SlowStartWorker workers[worker_count];
+    Aggregator aggregator;
+    uint32_t start = millis();
+    aggregator.set_deferred_initialization(true);
+    for (uint8_t i = 0; i < worker_count; ++i) {
+      aggregator.register_worker(i + 1, workers[i]);
+    }
+    CHECK(aggregator.boot(1000));
+    concurrent = first_report(aggregator, workers, start);
+  }
+
+  printf("time to first report of %u workers starting in 20 ms: %u ms one after another, %u ms with boot\n",
+         worker_count, sequential, concurrent);
+  CHECK(sequential >= worker_count * 20);
+  CHECK(concurrent < sequential / 2);
+}
+
+static void test_destructor_waits_for_boot_task() {
+  SlowStartWorker slow(200);
+  {
+    Aggregator aggregator;
+    aggregator.set_deferred_initialization(true);
+    aggregator.register_worker(1, slow);
+    aggregator.set_boot_timeout(Aggregator::e_component_worker, 1, 20);
+    CHECK(!aggregator.boot());
+    CHECK_EQUAL(Aggregator::e_boot_timeout, aggregator.get_boot_state(Aggregator::e_component_worker, 1));
+    CHECK(!slow.started);
+  }
+  // The task finished before the aggregator was gone
+  CHECK(slow.started);
+}
+
+int main() {
+  test_time_to_first_report();
+  test_destructor_waits_for_boot_task();
+  return check_result();
+}
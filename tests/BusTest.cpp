@@ -0,0 +1,193 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include "Aggregator.hpp"
+#include "BusArbiter.hpp"
+#include "Check.hpp"
+#include "Clock.hpp"
+
+/*
+ * BusArbiter over a SimulatedBus: bus transactions per second with and without bursts, readers without a job and
+ * readers under the tick budget.
+ */
+
+/**
+ * Clock moved by the test only, also in micros
+ */
+class StepClock : public Clock {
+ public:
+  uint32_t millis() const override {
+    return now_micros / 1000;
+  }
+
+  uint32_t micros() const override {
+    return now_micros;
+  }
+
+  uint32_t now_micros = 1000;
+};
+
+static StepClock test_clock;
+
+class Temperature : public BusReadWorker<float, 2> {
+ public:
+  Temperature(BusArbiter& arbiter, uint8_t address, uint32_t period)
+      : BusReadWorker<float, 2>(arbiter, address, 0x00, period) {
+  }
+
+ protected:
+  int8_t decode(const uint8_t* bytes) override {
+    data = (float) (int16_t) (bytes[0] << 8 | bytes[1]) / 100.0f;
+    return e_worker_data_read;
+  }
+};
+
+static const uint32_t periods[] = {100, 100, 200, 95};
+static const uint32_t seconds = 10;
+
+static void add_devices(SimulatedBus& bus) {
+  const uint8_t value[2] = {0x09, 0xC4}; // 25.00
+  for (uint8_t address = 0x40; address < 0x44; ++address) {
+    bus.set_register(address, 0x00, value, 2);
+  }
+}
+
+/**
+ * Run the devices for `seconds` through an arbiter
+ * @return bus statistics
+ */
+static SimulatedBus::Stats run_bursts(uint32_t coalesce_window, uint32_t& fresh, BusArbiter::Stats& arbiter_stats) {
+  SimulatedBus bus;
+  add_devices(bus);
+  BusArbiter arbiter(bus);
+  arbiter.set_coalesce_window(coalesce_window);
+  Temperature first(arbiter, 0x40, periods[0]);
+  Temperature second(arbiter, 0x41, periods[1]);
+  Temperature third(arbiter, 0x42, periods[2]);
+  Temperature fourth(arbiter, 0x43, periods[3]);
+  Temperature* sensors[] = {&first, &second, &third, &fourth};
+  Aggregator aggregator;
+  aggregator.register_worker(1, arbiter);
+  for (uint8_t i = 0; i < 4; ++i) {
+    aggregator.register_worker(2 + i, *sensors[i]);
+  }
+  for (uint8_t i = 1; i <= 5; ++i) {
+    aggregator.set_worker_active(i, true);
+  }
+  fresh = 0;
+  for (uint32_t tick = 0; tick < seconds * 1000; ++tick) {
+    aggregator.run();
+    for (auto sensor : sensors) {
+      fresh += sensor->is_fresh() ? 1 : 0;
+    }
+    test_clock.now_micros += 1000;
+  }
+  CHECK(first.get_data() == 25.0f);
+  arbiter_stats = arbiter.get_stats();
+  return bus.get_stats();
+}
+
+static void test_transactions_per_second() {
+  // Every sensor reading in a transaction of its own
+  SimulatedBus bus;
+  add_devices(bus);
+  uint32_t single_reads = 0;
+  for (uint32_t tick = 0; tick < seconds * 1000; ++tick) {
+    for (uint8_t i = 0; i < 4; ++i) {
+      if (tick % periods[i] == 0) {
+        uint8_t bytes[2];
+        bus.read_register((uint8_t) (0x40 + i), 0x00, bytes, 2);
+        ++single_reads;
+      }
+    }
+  }
+  SimulatedBus::Stats single = bus.get_stats();
+  CHECK_EQUAL(single_reads, single.transactions);
+
+  uint32_t fresh;
+  BusArbiter::Stats arbiter_stats;
+  SimulatedBus::Stats bursts = run_bursts(0, fresh, arbiter_stats);
+  CHECK_EQUAL(arbiter_stats.reads, fresh);
+  CHECK_EQUAL(arbiter_stats.bursts, bursts.transactions);
+  CHECK(bursts.transactions < single.transactions);
+
+  SimulatedBus::Stats coalesced = run_bursts(20, fresh, arbiter_stats);
+  CHECK(arbiter_stats.coalesced > 0);
+  CHECK(coalesced.transactions < bursts.transactions);
+
+  printf("transactions/s: single %u, bursts %u, coalesced %u\n", single.transactions / seconds,
+         bursts.transactions / seconds, coalesced.transactions / seconds);
+  printf("bus busy per second: single %u us, bursts %u us, coalesced %u us\n", single.busy_micros / seconds,
+         bursts.busy_micros / seconds, coalesced.busy_micros / seconds);
+}
+
+static void test_no_job() {
+  SimulatedBus bus;
+  add_devices(bus);
+  BusArbiter arbiter(bus);
+  uint8_t buffer[1];
+  while (arbiter.add_read(0x40, 0x00, buffer, 1, 1000) != BusArbiter::no_job) {
+  }
+  Temperature sensor(arbiter, 0x41, 100);
+  Aggregator aggregator;
+  aggregator.register_worker(1, arbiter);
+  aggregator.register_worker(2, sensor);
+  aggregator.set_worker_active(1, true);
+  aggregator.set_worker_active(2, true);
+  aggregator.run();
+  CHECK_EQUAL(BaseWorker::e_worker_error, sensor.get_status());
+}
+
+// Takes 2 ms of the tick budget on every run
+class SlowWorker : public Worker<int> {
+ public:
+  SlowWorker() : Worker<int>(0, 0) {
+  }
+
+ protected:
+  int8_t produce_data() override {
+    test_clock.now_micros += 2000;
+    return e_worker_data_read;
+  }
+};
+
+static void test_budget_keeps_reader() {
+  SimulatedBus bus;
+  add_devices(bus);
+  BusArbiter arbiter(bus);
+  SlowWorker slow;
+  Temperature sensor(arbiter, 0x40, 1000);
+  arbiter.set_priority(Activatable::e_priority_high);
+  slow.set_priority(Activatable::e_priority_high);
+  sensor.set_priority(Activatable::e_priority_low);
+  Aggregator aggregator;
+  aggregator.register_worker(1, slow);
+  aggregator.register_worker(2, arbiter);
+  aggregator.register_worker(3, sensor);
+  for (uint8_t i = 1; i <= 3; ++i) {
+    aggregator.set_worker_active(i, true);
+  }
+  aggregator.set_tick_budget(1000);
+
+  // The budget is exhausted, but the reader is a process worker with a fresh source: it is not deferred
+  aggregator.run();
+  CHECK(arbiter.is_fresh());
+  CHECK(sensor.is_fresh());
+  CHECK(sensor.get_data() == 25.0f);
+  CHECK_EQUAL(0, aggregator.get_tick_stats().deferrals[Activatable::e_priority_low]);
+
+  // The read is taken: no reading without a new burst
+  test_clock.now_micros += 1000;
+  aggregator.run();
+  CHECK(!arbiter.is_fresh());
+  CHECK(!sensor.is_fresh());
+}
+
+int main() {
+  Clock::set(test_clock);
+  test_transactions_per_second();
+  test_no_job();
+  test_budget_keeps_reader();
+  return check_result();
+}
@@ -0,0 +1,130 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include <math.h>
+#include <chrono>
+#include "Calibration.hpp"
+#include "Check.hpp"
+
+/*
+ * Accuracy and cost of lookup tables against the float formula: a 10k NTC (beta 3950, 12 bit ADC) over -40..120 C.
+ * The timings are for the host, on a chip without a double precision FPU the formula costs relatively more.
+ */
+
+typedef Thermistor<10000, 10000, 3950> Ntc;
+
+static double beta_formula(int32_t raw) {
+  double resistance = 10000.0 * raw / (4095.0 - raw);
+  return 1.0 / (1.0 / 298.15 + log(resistance / 10000.0) / 3950.0) - 273.15;
+}
+
+/**
+ * Largest difference between the table and the formula over the readings of -40..120 C
+ * @param worst_raw : receives the reading with the largest difference
+ */
+template<uint16_t N>
+static double max_error(int32_t& worst_raw) {
+  double worst = 0;
+  for (int32_t raw = Ntc::min_input; raw <= Ntc::max_input; ++raw) {
+    double expected = beta_formula(raw);
+    if (expected < -40.0 || expected > 120.0) {
+      continue;
+    }
+    double error = fabs(from_fixed(LookupTable<Ntc, N>::evaluate(raw)) - expected);
+    if (error > worst) {
+      worst = error;
+      worst_raw = raw;
+    }
+  }
+  return worst;
+}
+
+static void test_table_accuracy() {
+  int32_t raw = 0;
+  double error = max_error<64>(raw);
+  printf("64 points: max error %.4f C at raw %d\n", error, raw);
+  CHECK(error < 1.0);
+  error = max_error<256>(raw);
+  printf("256 points: max error %.4f C at raw %d\n", error, raw);
+  CHECK(error < 0.055);
+  error = max_error<512>(raw);
+  printf("512 points: max error %.4f C at raw %d\n", error, raw);
+  CHECK(error < 0.015);
+}
+
+/**
+ * The beta formula as a sketch would evaluate it at run time, in float
+ */
+static float beta_formula_float(int32_t raw) {
+  float resistance = 10000.0f * raw / (4095.0f - raw);
+  return 1.0f / (1.0f / 298.15f + logf(resistance / 10000.0f) / 3950.0f) - 273.15f;
+}
+
+/**
+ * Time a conversion over a set of readings
+ * @param name
+ * @param convert : converts a reading to degrees
+ * @return nanoseconds per conversion
+ */
+template<typename Convert>
+static double time_conversion(const char* name, const int32_t* readings, size_t count, Convert convert) {
+  const int rounds = 2000;
+  double checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; ++round) {
+    for (size_t i = 0; i < count; ++i) {
+      checksum += convert(readings[i]);
+    }
+  }
+  auto nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  double per_conversion = nanos / ((double) rounds * count);
+  printf("%-16s %6.2f ns per conversion (checksum %.0f)\n", name, per_conversion, checksum);
+  return per_conversion;
+}
+
+static void test_table_cost() {
+  // Pseudo random readings over the whole range, so neither side profits from predictable branches
+  static int32_t readings[4096];
+  uint32_t state = 12345;
+  for (auto& reading : readings) {
+    state = state * 1103515245u + 12345u;
+    reading = Ntc::min_input + (int32_t) ((state >> 8) % (uint32_t) (Ntc::max_input - Ntc::min_input + 1));
+  }
+  size_t count = sizeof(readings) / sizeof(readings[0]);
+  double formula = time_conversion("float formula", readings, count, [](int32_t raw) {
+    return (double) beta_formula_float(raw);
+  });
+  double table = time_conversion("256 point table", readings, count, [](int32_t raw) {
+    return from_fixed(LookupTable<Ntc, 256>::evaluate(raw));
+  });
+  printf("table is %.1fx faster\n", formula / table);
+  CHECK(table < formula);
+}
+
+static void test_compile_time_math() {
+  for (double x = 0.01; x < 1000; x *= 1.7) {
+    CHECK(fabs(calibration_math::log(x) - log(x)) < 1e-9);
+  }
+  for (double x = -10; x < 10; x += 0.7) {
+    CHECK(fabs(calibration_math::exp(x) / exp(x) - 1) < 1e-9);
+  }
+  // Nominal resistance at half scale is the nominal temperature
+  CHECK(fabs(Ntc::evaluate(2047.5) - 25.0) < 1e-9);
+}
+
+static void test_clamping() {
+  typedef LookupTable<Ntc, 256> Table;
+  CHECK_EQUAL(Table::point(0), Table::evaluate(0));
+  CHECK_EQUAL(Table::point(0), Table::evaluate(-5));
+  CHECK_EQUAL(Table::point(255), Table::evaluate(4095));
+  CHECK_EQUAL(Table::point(255), Table::evaluate(Ntc::max_input));
+}
+
+int main() {
+  test_table_accuracy();
+  test_table_cost();
+  test_compile_time_math();
+  test_clamping();
+  return check_result();
+}
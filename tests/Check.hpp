@@ -0,0 +1,44 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_TESTS_CHECK_HPP_
+#define SENSOR_REPORTER_TESTS_CHECK_HPP_
+
+#include <stdio.h>
+
+/*
+ * Minimal checks for the host tests: a failed check prints its location, the test returns check_result() from main.
+ */
+
+static int check_failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      ++check_failures; \
+    } \
+  } while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+  do { \
+    long long check_expected = (long long) (expected); \
+    long long check_actual = (long long) (actual); \
+    if (check_expected != check_actual) { \
+      printf("%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #expected, #actual, \
+             check_expected, check_actual); \
+      ++check_failures; \
+    } \
+  } while (0)
+
+static int check_result() {
+  if (check_failures) {
+    printf("%d check(s) failed\n", check_failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
+
+#endif //SENSOR_REPORTER_TESTS_CHECK_HPP_
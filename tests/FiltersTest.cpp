@@ -0,0 +1,100 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include <math.h>
+#include <chrono>
+#include "Check.hpp"
+#include "Filters.hpp"
+
+/*
+ * Biquad accuracy at low normalized cutoffs against a double precision biquad, and samples per second of every filter.
+ */
+
+/**
+ * The same low pass in double precision
+ */
+struct ReferenceLowpass {
+  ReferenceLowpass(double ratio, double q) : x1(0), x2(0), y1(0), y2(0) {
+    double w0 = 2.0 * M_PI * ratio;
+    double alpha = sin(w0) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+    b0 = (1.0 - cos(w0)) / 2.0 / a0;
+    b1 = 2.0 * b0;
+    b2 = b0;
+    a1 = -2.0 * cos(w0) / a0;
+    a2 = (1.0 - alpha) / a0;
+  }
+
+  double push(double x) {
+    double y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    return y;
+  }
+
+  double b0, b1, b2, a1, a2;
+  double x1, x2, y1, y2;
+};
+
+static void test_biquad_low_cutoff() {
+  const float ratios[] = {0.1f, 0.01f, 0.004f, 0.002f, 0.001f};
+  for (float ratio : ratios) {
+    Biquad lowpass(Biquad::Coefficients::lowpass(ratio * 1000.0f, 1000.0f));
+    Biquad highpass(Biquad::Coefficients::highpass(ratio * 1000.0f, 1000.0f));
+    ReferenceLowpass reference(ratio, 0.7071);
+    // Step of 10 for 20 time constants
+    const fixed_t step = to_fixed(10.0f);
+    auto samples = (int) (20.0f / ratio);
+    fixed_t low = 0;
+    fixed_t high = 0;
+    double step_error = 0;
+    for (int i = 0; i < samples; ++i) {
+      lowpass.push(step, low);
+      highpass.push(step, high);
+      double error = fabs(from_fixed(low) - reference.push(10.0));
+      step_error = error > step_error ? error : step_error;
+    }
+    float gain = from_fixed(low) / 10.0f;
+    printf("fc/fs %.3f: dc gain %.6f, step response error %.6f, high pass dc %.6f\n", ratio, gain, step_error,
+           from_fixed(high));
+    CHECK(fabsf(gain - 1.0f) < 1e-4f);
+    CHECK(step_error < 1e-2);
+    CHECK(fabsf(from_fixed(high)) < 1e-2f);
+  }
+}
+
+static const size_t block = 1024;
+static const int blocks = 2000;
+
+template<typename Filter>
+static void benchmark(const char* name, Filter filter) {
+  fixed_t in[block];
+  fixed_t out[block];
+  for (size_t i = 0; i < block; ++i) {
+    in[i] = to_fixed(20.0f + (float) (i % 37) * 0.1f);
+  }
+  int64_t checksum = 0;
+  size_t produced = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int b = 0; b < blocks; ++b) {
+    produced += filter.process(in, out, block);
+    checksum += out[0];
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  CHECK(produced > 0);
+  printf("%-20s %6.1f M samples/s (checksum %lld)\n", name, block * blocks / seconds / 1e6, (long long) checksum);
+}
+
+int main() {
+  test_biquad_low_cutoff();
+  benchmark("MovingAverage<16>", MovingAverage<16>());
+  benchmark("ExponentialAverage", ExponentialAverage(to_fixed(0.1f)));
+  benchmark("SlidingMedian<5>", SlidingMedian<5>());
+  benchmark("SlidingMedian<31>", SlidingMedian<31>());
+  benchmark("Biquad", Biquad(Biquad::Coefficients::lowpass(10.0f, 1000.0f)));
+  benchmark("Decimator<8>", Decimator<8>());
+  return check_result();
+}
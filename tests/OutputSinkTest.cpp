@@ -0,0 +1,96 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Check.hpp"
+#include "OutputSink.hpp"
+
+/*
+ * OutputSink with several producer threads and a draining thread: throughput, and every record is either drained or
+ * counted as dropped. The producers retry dropped records so all of them reach the output.
+ */
+
+static void test_drop_count() {
+  CountingOutput out;
+  FixedOutputSink<8, 16> sink(out);
+  for (int i = 0; i < 20; ++i) {
+    sink.printf("record %d", i);
+  }
+  OutputSink::Stats stats = sink.get_stats();
+  CHECK_EQUAL(8, stats.records);
+  CHECK_EQUAL(12, stats.dropped);
+  CHECK_EQUAL(8, sink.pending());
+  CHECK(sink.printf("dropped") == 0);
+
+  CHECK_EQUAL(8, sink.drain());
+  CHECK_EQUAL(8, out.get_writes());
+  CHECK_EQUAL(0, sink.pending());
+  // The slots are free again
+  CHECK(sink.printf("record %d", 20) > 0);
+  CHECK_EQUAL(1, sink.drain());
+}
+
+static void test_truncation() {
+  CountingOutput out;
+  FixedOutputSink<4, 8> sink(out);
+  CHECK_EQUAL(7, sink.printf("%s", "longer than a slot"));
+  CHECK_EQUAL(1, sink.get_stats().truncated);
+  // Writes are split over records instead
+  CHECK_EQUAL(18, sink.write((const uint8_t*) "longer than a slot", 18));
+  CHECK_EQUAL(4, sink.get_stats().records);
+  sink.drain();
+  CHECK_EQUAL(7 + 18, out.get_bytes());
+}
+
+static void test_throughput() {
+  const int producers = 4;
+  const int per_producer = 50000;
+  CountingOutput out;
+  FixedOutputSink<256, 32> sink(out);
+  std::atomic<bool> producing(true);
+
+  std::thread consumer([&]() {
+    while (producing) {
+      if (sink.drain() == 0) {
+        std::this_thread::yield();
+      }
+    }
+    sink.drain();
+  });
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&sink, p, per_producer]() {
+      for (int i = 0; i < per_producer; ++i) {
+        while (sink.printf("producer %d record %d", p, i) == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  producing = false;
+  consumer.join();
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  OutputSink::Stats stats = sink.get_stats();
+  CHECK_EQUAL(producers * per_producer, stats.records);
+  CHECK_EQUAL(stats.records, stats.drained);
+  CHECK_EQUAL(stats.records, out.get_writes());
+  CHECK_EQUAL(0, stats.truncated);
+  CHECK_EQUAL(0, sink.pending());
+  printf("%d producers: %.0f records/s drained, %u dropped on a full ring\n", producers, stats.drained / seconds,
+         stats.dropped);
+}
+
+int main() {
+  test_drop_count();
+  test_truncation();
+  test_throughput();
+  return check_result();
+}
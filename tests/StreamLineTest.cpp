@@ -0,0 +1,151 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include <new>
+#include <stdlib.h>
+#include <string>
+#include "Aggregator.hpp"
+#include "Check.hpp"
+#include "StreamLineWorker.hpp"
+
+/*
+ * StreamLineWorker and StreamCommandWorker fed from a fake stream one byte per run: lines complete across runs, without
+ * heap allocations, and their data is not copied into snapshots.
+ */
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+  ++allocations;
+  void* memory = malloc(size ? size : 1);
+  if (!memory) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void operator delete(void* memory) noexcept {
+  free(memory);
+}
+
+/**
+ * Stream of the bytes fed to it
+ */
+class FakeStream : public Stream {
+ public:
+  void feed(char byte) {
+    bytes += byte;
+  }
+
+  int available() override {
+    return (int) (bytes.size() - position);
+  }
+
+  int read() override {
+    return position < bytes.size() ? (uint8_t) bytes[position++] : -1;
+  }
+
+  int peek() override {
+    return position < bytes.size() ? (uint8_t) bytes[position] : -1;
+  }
+
+  size_t write(uint8_t byte) override {
+    return 1;
+  }
+
+  std::string bytes;
+  size_t position = 0;
+};
+
+static void test_lines_byte_by_byte() {
+  FakeStream stream;
+  stream.bytes.reserve(256);
+  StreamLineWorker<16> worker(stream);
+  Aggregator aggregator;
+  aggregator.register_worker(1, worker);
+  aggregator.set_worker_active(1, true);
+
+  const char input[] = "first\r\nsecond  \nthis line is too long\n\nlast\n";
+  const char* expected[] = {"first", "second", "", "last"};
+  size_t lines = 0;
+  size_t allocated = allocations;
+  for (const char* byte = input; *byte; ++byte) {
+    stream.feed(*byte);
+    aggregator.run();
+    if (worker.is_fresh()) {
+      // Fresh exactly on the delimiter
+      CHECK(*byte == '\n');
+      CHECK(lines < 4);
+      if (lines < 4) {
+        CHECK(strcmp(expected[lines], worker.get_data().text) == 0);
+        CHECK_EQUAL(strlen(expected[lines]), worker.get_data().length);
+      }
+      ++lines;
+    }
+  }
+  CHECK_EQUAL(4, lines);
+  CHECK_EQUAL(allocated, allocations);
+}
+
+static void test_commands_byte_by_byte() {
+  static const CommandSpec table[] = {
+      {"t", 1, CommandSpec::e_arg_int},
+      {"led", 2, CommandSpec::e_arg_bool},
+      {"say", 3, CommandSpec::e_arg_word},
+  };
+  FakeStream stream;
+  stream.bytes.reserve(256);
+  StreamCommandWorker<32> worker(stream, table, 3);
+  Aggregator aggregator;
+  aggregator.register_worker(1, worker);
+  aggregator.set_worker_active(1, true);
+
+  const char input[] = "t 22\nled on\nnope\nsay hello there\n";
+  size_t commands = 0;
+  size_t errors = 0;
+  size_t allocated = allocations;
+  for (const char* byte = input; *byte; ++byte) {
+    stream.feed(*byte);
+    aggregator.run();
+    if (worker.get_status() == BaseWorker::e_worker_error) {
+      ++errors;
+    }
+    if (!worker.is_fresh()) {
+      continue;
+    }
+    const Command& command = worker.get_data();
+    switch (commands++) {
+      case 0:
+        CHECK_EQUAL(1, command.type);
+        CHECK_EQUAL(22, command.int_value);
+        break;
+      case 1:
+        CHECK_EQUAL(2, command.type);
+        CHECK_EQUAL(1, command.int_value);
+        break;
+      default:
+        CHECK_EQUAL(3, command.type);
+        CHECK(strncmp("hello there", command.word, command.word_length) == 0);
+        CHECK_EQUAL(11, command.word_length);
+    }
+  }
+  CHECK_EQUAL(3, commands);
+  CHECK_EQUAL(1, errors);
+  CHECK_EQUAL(allocated, allocations);
+}
+
+static void test_not_raw_copyable() {
+  FakeStream stream;
+  StreamLineWorker<16> lines(stream);
+  CHECK(!is_raw_copyable<StreamLine>::value);
+  CHECK(!is_raw_copyable<Command>::value);
+  CHECK(lines.get_raw_data() == nullptr);
+}
+
+int main() {
+  test_lines_byte_by_byte();
+  test_commands_byte_by_byte();
+  test_not_raw_copyable();
+  return check_result();
+}
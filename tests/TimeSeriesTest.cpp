@@ -0,0 +1,116 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "Check.hpp"
+#include "TimeSeries.hpp"
+
+/*
+ * TimeSeriesEncoder on DHT like traces: lossless round trip, compression ratio and encode time per sample, and a full
+ * buffer keeping a complete series.
+ */
+
+struct Trace {
+  std::vector<uint32_t> timestamps;
+  std::vector<float> values;
+};
+
+static uint32_t random_state = 1;
+
+// Deterministic traces on every platform
+static uint32_t next_random() {
+  random_state = random_state * 1103515245u + 12345u;
+  return (random_state >> 16) & 0x7FFF;
+}
+
+/**
+ * Readings every 2 s with some jitter, a value that steps by `step` now and then (at `change_percent` of the samples)
+ */
+static Trace make_trace(size_t samples, float start, float step, uint32_t change_percent) {
+  Trace trace;
+  uint32_t timestamp = 123456;
+  float value = start;
+  for (size_t i = 0; i < samples; ++i) {
+    timestamp += 2000 + (next_random() % 7 == 0 ? next_random() % 5 : 0);
+    if (next_random() % 100 < change_percent) {
+      value += ((int) (next_random() % 3) - 1) * step;
+    }
+    trace.timestamps.push_back(timestamp);
+    // Readings come in steps of 0.1 like the sensor reports them
+    trace.values.push_back(roundf(value * 10) / 10);
+  }
+  return trace;
+}
+
+static void check_trace(const char* name, const Trace& trace, float min_ratio) {
+  static uint8_t buffer[16384];
+  TimeSeriesEncoder encoder(buffer, sizeof(buffer));
+  const int repeats = 200;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; ++r) {
+    encoder.reset();
+    for (size_t i = 0; i < trace.timestamps.size(); ++i) {
+      if (!encoder.append(trace.timestamps[i], trace.values[i])) {
+        break;
+      }
+    }
+  }
+  auto nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  CHECK_EQUAL(trace.timestamps.size(), encoder.get_count());
+
+  TimeSeriesDecoder decoder(encoder.data(), encoder.size(), encoder.get_count());
+  uint32_t timestamp;
+  float value;
+  size_t decoded = 0;
+  size_t mismatches = 0;
+  while (decoder.next(timestamp, value)) {
+    if (timestamp != trace.timestamps[decoded] || value != trace.values[decoded]) {
+      ++mismatches;
+    }
+    ++decoded;
+  }
+  CHECK(!decoder.failed());
+  CHECK_EQUAL(trace.timestamps.size(), decoded);
+  CHECK_EQUAL(0, mismatches);
+
+  // Raw: a 32 bit timestamp and a 32 bit float per sample
+  double ratio = 8.0 * encoder.get_count() / encoder.size();
+  printf("%-12s %u samples in %u bytes: %.1fx compression, %.1f ns per sample\n", name, encoder.get_count(),
+         (unsigned) encoder.size(), ratio, nanos / repeats / encoder.get_count());
+  CHECK(ratio >= min_ratio);
+}
+
+static void test_full_buffer() {
+  Trace trace = make_trace(100, 21.3f, 0.7f, 100);
+  uint8_t buffer[20];
+  TimeSeriesEncoder encoder(buffer, sizeof(buffer));
+  size_t appended = 0;
+  while (appended < trace.timestamps.size() && encoder.append(trace.timestamps[appended], trace.values[appended])) {
+    ++appended;
+  }
+  CHECK(appended > 0 && appended < trace.timestamps.size());
+  CHECK(encoder.size() <= sizeof(buffer));
+
+  // The sample that did not fit is rolled back, the series decodes completely
+  TimeSeriesDecoder decoder(encoder.data(), encoder.size(), encoder.get_count());
+  uint32_t timestamp;
+  float value;
+  size_t decoded = 0;
+  while (decoder.next(timestamp, value)) {
+    CHECK_EQUAL(trace.timestamps[decoded], timestamp);
+    CHECK(trace.values[decoded] == value);
+    ++decoded;
+  }
+  CHECK(!decoder.failed());
+  CHECK_EQUAL(appended, decoded);
+}
+
+int main() {
+  check_trace("temperature", make_trace(2000, 21.3f, 0.1f, 10), 8.0f);
+  check_trace("humidity", make_trace(2000, 55.0f, 0.1f, 40), 4.0f);
+  test_full_buffer();
+  return check_result();
+}
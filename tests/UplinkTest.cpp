@@ -0,0 +1,207 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include <chrono>
+#include <string>
+#include "Aggregator.hpp"
+#include "Check.hpp"
+#include "Clock.hpp"
+#include "HttpUplinkHandler.hpp"
+
+/*
+ * HttpUplinkHandler over a LoopbackTransport: batching, retrying batches after a lost connection, a full queue, runs
+ * without fresh data, and records per second through the loopback.
+ */
+
+static VirtualClock test_clock(1000);
+static const char* const ok_response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+
+class CountWorker : public Worker<uint32_t> {
+ public:
+  CountWorker() : Worker<uint32_t>(0u, 0) {
+  }
+
+ protected:
+  int8_t produce_data() override {
+    ++data;
+    return e_worker_data_read;
+  }
+};
+
+// Records of 10 bytes: {"v":1001}
+class CountUplink : public HttpUplinkHandler {
+ public:
+  CountUplink(UplinkTransport& transport, size_t queue_size, uint16_t batch_records)
+      : HttpUplinkHandler(transport, "host", "/api", queue_size, batch_records, 60000) {
+  }
+
+ protected:
+  size_t encode_record(const WorkerMap& workers, char* buffer, size_t capacity) override {
+    return (size_t) snprintf(buffer, capacity, "{\"v\":%u}", 1000 + workers.worker<CountWorker>(1)->get_data());
+  }
+};
+
+static size_t count(const std::string& text, const char* word) {
+  size_t found = 0;
+  for (size_t position = text.find(word); position != std::string::npos; position = text.find(word, position + 1)) {
+    ++found;
+  }
+  return found;
+}
+
+static std::string take_written(LoopbackTransport& transport) {
+  std::string written(transport.get_written().begin(), transport.get_written().end());
+  transport.clear_written();
+  return written;
+}
+
+struct Setup {
+  Setup(size_t queue_size, uint16_t batch_records) : uplink(transport, queue_size, batch_records) {
+    aggregator.register_worker(1, worker);
+    aggregator.register_handler(1, uplink);
+    aggregator.set_worker_active(1, true);
+    aggregator.set_handler_active(1, true);
+  }
+
+  void run(int runs) {
+    for (int i = 0; i < runs; ++i) {
+      aggregator.run();
+    }
+  }
+
+  LoopbackTransport transport;
+  CountWorker worker;
+  CountUplink uplink;
+  Aggregator aggregator;
+};
+
+static void test_batches() {
+  Setup setup(1024, 3);
+  setup.run(6);
+  std::string written = take_written(setup.transport);
+  CHECK_EQUAL(2, count(written, "POST /api HTTP/1.1"));
+  CHECK(written.find("[{\"v\":1001},{\"v\":1002},{\"v\":1003}]") != std::string::npos);
+  CHECK(written.find("[{\"v\":1004},{\"v\":1005},{\"v\":1006}]") != std::string::npos);
+
+  setup.transport.respond(ok_response);
+  setup.transport.respond(ok_response);
+  setup.run(1);
+  CHECK_EQUAL(6, setup.uplink.get_stats().records_sent);
+  CHECK_EQUAL(0, setup.uplink.get_stats().records_dropped);
+}
+
+static void test_retry_after_connection_loss() {
+  Setup setup(1024, 2);
+  setup.run(4);
+  CHECK_EQUAL(2, count(take_written(setup.transport), "POST"));
+
+  // Both requests lose their response, and reconnecting fails once
+  setup.transport.drop();
+  setup.transport.set_reachable(false);
+  setup.run(1);
+  CHECK_EQUAL(1, setup.uplink.get_stats().connection_losses);
+  CHECK(!setup.transport.connected());
+  setup.transport.set_reachable(true);
+  // Past the backoff
+  test_clock.advance(1000);
+  setup.run(1);
+  CHECK(setup.transport.connected());
+
+  // The unacknowledged batches are sent again, in order
+  std::string written = take_written(setup.transport);
+  CHECK_EQUAL(2, count(written, "POST"));
+  size_t first = written.find("[{\"v\":1001},{\"v\":1002}]");
+  size_t second = written.find("[{\"v\":1003},{\"v\":1004}]");
+  CHECK(first != std::string::npos && second != std::string::npos && first < second);
+
+  setup.transport.respond(ok_response);
+  setup.transport.respond(ok_response);
+  setup.run(1);
+  CHECK_EQUAL(4, setup.uplink.get_stats().records_sent);
+  CHECK_EQUAL(0, setup.uplink.get_stats().records_dropped);
+}
+
+static void test_full_queue() {
+  // Three records with separators fill the queue (the last byte is left for the null terminator of snprintf)
+  Setup setup(33, 10);
+  setup.uplink.set_max_in_flight(1);
+  setup.run(3);
+  CHECK_EQUAL(0, count(take_written(setup.transport), "POST"));
+
+  // No room: the record is dropped and the pending records are sent
+  setup.run(1);
+  CHECK_EQUAL(1, setup.uplink.get_stats().records_dropped);
+  std::string written = take_written(setup.transport);
+  CHECK_EQUAL(1, count(written, "POST"));
+  CHECK(written.find("[{\"v\":1001},{\"v\":1002},{\"v\":1003}]") != std::string::npos);
+
+  // The batch waiting for its response keeps the queue full
+  setup.run(2);
+  CHECK_EQUAL(3, setup.uplink.get_stats().records_dropped);
+
+  setup.transport.respond(ok_response);
+  setup.run(1);
+  CHECK_EQUAL(3, setup.uplink.get_stats().records_sent);
+  CHECK_EQUAL(4, setup.uplink.get_stats().records_queued);
+  CHECK_EQUAL(3, setup.uplink.get_stats().records_dropped);
+}
+
+static void test_runs_without_fresh_data() {
+  Setup setup(1024, 10);
+  setup.run(2);
+  // The worker stops producing, the partial batch is still sent after the delay of 60 s
+  setup.aggregator.set_worker_active(1, false);
+  setup.run(1);
+  CHECK_EQUAL(0, count(take_written(setup.transport), "POST"));
+  test_clock.advance(60000);
+  setup.run(1);
+  std::string written = take_written(setup.transport);
+  CHECK_EQUAL(1, count(written, "POST"));
+  CHECK(written.find("[{\"v\":1001},{\"v\":1002}]") != std::string::npos);
+
+  // And its response is read
+  setup.transport.respond(ok_response);
+  setup.run(1);
+  CHECK_EQUAL(2, setup.uplink.get_stats().records_sent);
+}
+
+static void test_throughput() {
+  const uint32_t records = 200000;
+  Setup setup(4096, 50);
+  uint32_t answered = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (setup.uplink.get_stats().records_queued < records) {
+    setup.run(1);
+    // The server answers every request it received
+    for (; answered < setup.uplink.get_stats().requests; ++answered) {
+      setup.transport.respond(ok_response);
+    }
+    setup.transport.clear_written();
+  }
+  setup.aggregator.set_worker_active(1, false);
+  test_clock.advance(60000);
+  while (setup.uplink.get_stats().records_sent < records && answered < records) {
+    setup.run(1);
+    for (; answered < setup.uplink.get_stats().requests; ++answered) {
+      setup.transport.respond(ok_response);
+    }
+    setup.transport.clear_written();
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const HttpUplinkHandler::Stats& stats = setup.uplink.get_stats();
+  CHECK_EQUAL(records, stats.records_sent);
+  CHECK_EQUAL(0, stats.records_dropped);
+  printf("%u records in %u requests: %.0f records/s over the loopback\n", stats.records_sent, stats.requests,
+         stats.records_sent / seconds);
+}
+
+int main() {
+  Clock::set(test_clock);
+  test_batches();
+  test_retry_after_connection_loss();
+  test_full_queue();
+  test_runs_without_fresh_data();
+  test_throughput();
+  return check_result();
+}
@@ -0,0 +1,257 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <stdarg.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+static const auto host_start = std::chrono::steady_clock::now();
+static std::recursive_mutex critical;
+static thread_local TaskHandle_t current_task = nullptr;
+
+/**
+ * Counting semaphore, a mutex is a semaphore of one that remembers its owner (for the recursive take)
+ */
+struct HostSemaphore {
+  std::mutex mutex;
+  std::condition_variable changed;
+  UBaseType_t count;
+  UBaseType_t max_count;
+  bool is_mutex;
+  std::thread::id owner;
+  uint32_t depth;
+};
+
+static SemaphoreHandle_t create_semaphore(UBaseType_t max_count, UBaseType_t initial_count, bool is_mutex) {
+  return new HostSemaphore{{}, {}, initial_count, max_count, is_mutex, {}, 0};
+}
+
+/**
+ * Queue of fixed size items
+ */
+struct HostQueue {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<uint8_t>> items;
+  UBaseType_t length;
+  UBaseType_t item_size;
+};
+
+/**
+ * Wait on a condition for a FreeRTOS amount of ticks (1 ms)
+ */
+template<typename Ready>
+static bool wait_ticks(std::condition_variable& changed, std::unique_lock<std::mutex>& lock, TickType_t ticks,
+                       Ready ready) {
+  if (ticks == portMAX_DELAY) {
+    changed.wait(lock, ready);
+    return true;
+  }
+  return changed.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+void host_enter_critical(portMUX_TYPE* mux) {
+  critical.lock();
+}
+
+void host_exit_critical(portMUX_TYPE* mux) {
+  critical.unlock();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t memory, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+  // The handle only identifies the task
+  static std::atomic<uintptr_t> next_task(1);
+  auto task_handle = (TaskHandle_t) (next_task++ * 16);
+  if (handle) {
+    *handle = task_handle;
+  }
+  std::thread([task, parameter, task_handle]() {
+    current_task = task_handle;
+    task(parameter);
+  }).detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+}
+
+void vTaskSuspend(TaskHandle_t task) {
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+void vTaskDelayUntil(TickType_t* last_wake, TickType_t ticks) {
+  *last_wake += ticks;
+  auto wait = (int32_t) (*last_wake - xTaskGetTickCount());
+  if (wait > 0) {
+    vTaskDelay((TickType_t) wait);
+  }
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t) millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return current_task;
+}
+
+BaseType_t xPortGetCoreID() {
+  return 0;
+}
+
+void taskYIELD() {
+  std::this_thread::yield();
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+  return 0;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return create_semaphore(1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+  return create_semaphore(max_count, initial_count, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return create_semaphore(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return create_semaphore(1, 1, true);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  if (!wait_ticks(semaphore->changed, lock, ticks, [semaphore] { return semaphore->count > 0; })) {
+    return pdFALSE;
+  }
+  --semaphore->count;
+  semaphore->owner = std::this_thread::get_id();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  if (semaphore->count >= semaphore->max_count) {
+    return pdFALSE;
+  }
+  ++semaphore->count;
+  semaphore->owner = std::thread::id();
+  semaphore->changed.notify_one();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  {
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->depth && semaphore->owner == std::this_thread::get_id()) {
+      ++semaphore->depth;
+      return pdTRUE;
+    }
+  }
+  if (xSemaphoreTake(semaphore, ticks) != pdTRUE) {
+    return pdFALSE;
+  }
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  semaphore->depth = 1;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+  {
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (!semaphore->depth || semaphore->owner != std::this_thread::get_id()) {
+      return pdFALSE;
+    }
+    if (--semaphore->depth) {
+      return pdTRUE;
+    }
+  }
+  return xSemaphoreGive(semaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  return new HostQueue{{}, {}, {}, length, item_size};
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!wait_ticks(queue->changed, lock, ticks, [queue] { return queue->items.size() < queue->length; })) {
+    return pdFALSE;
+  }
+  auto bytes = (const uint8_t*) item;
+  queue->items.emplace_back(bytes, bytes + queue->item_size);
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!wait_ticks(queue->changed, lock, ticks, [queue] { return !queue->items.empty(); })) {
+    return pdFALSE;
+  }
+  memcpy(item, queue->items.front().data(), queue->item_size);
+  queue->items.pop_front();
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+unsigned long micros() {
+  auto elapsed = std::chrono::steady_clock::now() - host_start;
+  return (unsigned long) (uint32_t) std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void delay(uint32_t millis) {
+  vTaskDelay(millis);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length < 0) {
+    return 0;
+  }
+  return write((const uint8_t*) buffer, std::min((size_t) length, sizeof(buffer) - 1));
+}
@@ -0,0 +1,182 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_TESTS_HOST_ARDUINO_H_
+#define SENSOR_REPORTER_TESTS_HOST_ARDUINO_H_
+
+/*
+ * The part of the Arduino / FreeRTOS API the library uses, to build it on the host for tests.
+ * Tasks run on threads, semaphores, mutexes and queues work across them. Priorities, cores and stack sizes are
+ * ignored, a task can only delete itself (vTaskDelete(nullptr), which returns: end the task function after it).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+typedef void* TaskHandle_t;
+typedef struct HostQueue* QueueHandle_t;
+typedef struct HostSemaphore* SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+
+struct portMUX_TYPE {
+  int unused;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) host_enter_critical(mux)
+#define portEXIT_CRITICAL(mux) host_exit_critical(mux)
+#define portMAX_DELAY 0xFFFFFFFF
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(millis) ((TickType_t) (millis))
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+#define BUILTIN_LED 2
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+
+void host_enter_critical(portMUX_TYPE* mux);
+void host_exit_critical(portMUX_TYPE* mux);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t memory, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskSuspend(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* last_wake, TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xPortGetCoreID();
+void taskYIELD();
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks);
+void vQueueDelete(QueueHandle_t queue);
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t millis);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+class String : public std::string {
+ public:
+  String() = default;
+  String(const char* text) : std::string(text) {
+  }
+  long toInt() const {
+    return atol(c_str());
+  }
+  int indexOf(char c) const {
+    size_t position = find(c);
+    return position == npos ? -1 : (int) position;
+  }
+};
+
+class Print {
+ public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t byte) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t length) {
+    size_t written = 0;
+    while (written < length && write(buffer[written])) {
+      ++written;
+    }
+    return written;
+  }
+  size_t write(const char* text) {
+    return write((const uint8_t*) text, strlen(text));
+  }
+  size_t write(const char* buffer, size_t length) {
+    return write((const uint8_t*) buffer, length);
+  }
+  virtual int availableForWrite() {
+    return 0;
+  }
+  size_t print(const char* text) {
+    return write(text);
+  }
+  size_t println(const char* text = "") {
+    return write(text) + write("\r\n");
+  }
+  size_t printf(const char* format, ...) __attribute__ ((format (printf, 2, 3)));
+  virtual void flush() {
+  }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    int c;
+    while (count < length && (c = read()) >= 0) {
+      buffer[count++] = (char) c;
+    }
+    return count;
+  }
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    return readBytes((char*) buffer, length);
+  }
+  void setTimeout(unsigned long timeout) {
+  }
+};
+
+/**
+ * Serial writes to stdout
+ */
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long baud) {
+  }
+  int available() override {
+    return 0;
+  }
+  int read() override {
+    return -1;
+  }
+  int peek() override {
+    return -1;
+  }
+  size_t write(uint8_t byte) override {
+    return fwrite(&byte, 1, 1, stdout);
+  }
+  size_t write(const uint8_t* buffer, size_t length) override {
+    return fwrite(buffer, 1, length, stdout);
+  }
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif //SENSOR_REPORTER_TESTS_HOST_ARDUINO_H_
@@ -0,0 +1,20 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_TESTS_HOST_CLIENT_H_
+#define SENSOR_REPORTER_TESTS_HOST_CLIENT_H_
+
+#include <Arduino.h>
+
+class Client : public Stream {
+ public:
+  virtual int connect(const char* host, uint16_t port) = 0;
+  virtual uint8_t connected() = 0;
+  virtual void stop() = 0;
+  virtual int read(uint8_t* buffer, size_t length) = 0;
+  using Stream::read;
+  using Print::write;
+};
+
+#endif //SENSOR_REPORTER_TESTS_HOST_CLIENT_H_
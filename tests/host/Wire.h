@@ -0,0 +1,38 @@
+//
+// Created by Jelle Bouwhuis on 10/19/26.
+//
+
+#ifndef SENSOR_REPORTER_TESTS_HOST_WIRE_H_
+#define SENSOR_REPORTER_TESTS_HOST_WIRE_H_
+
+#include <Arduino.h>
+
+/**
+ * I2C bus without devices: every transmission is acknowledged, reads return nothing. Use SimulatedBus to test bus code
+ */
+class TwoWire {
+ public:
+  void beginTransmission(uint8_t address) {
+  }
+  size_t write(uint8_t byte) {
+    return 1;
+  }
+  size_t write(const uint8_t* buffer, size_t length) {
+    return length;
+  }
+  uint8_t endTransmission(bool stop = true) {
+    return 0;
+  }
+  uint8_t requestFrom(int address, int length) {
+    return 0;
+  }
+  int read() {
+    return -1;
+  }
+  void setClock(uint32_t frequency) {
+  }
+};
+
+extern TwoWire Wire;
+
+#endif //SENSOR_REPORTER_TESTS_HOST_WIRE_H_
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+Convert a SensorReporter trace dump (Tracer::dump) to Chrome/Perfetto trace JSON.
+
+The input may be a raw serial capture, the dump is located by its "SRTR" magic (the first one with a valid header).
+Usage: trace_to_chrome.py <serial_capture.bin> [output.json]
+"""
+import json
+import struct
+import sys
+
+COMPONENTS = ["aggregator", "worker", "handler", "supervisor"]
+STAGES = ["tick", "work", "handle", "task", "finish", "report"]
+
+
+HEADER_SIZE = 12
+EVENT_SIZE = 8
+
+
+def find_dump(data):
+    # The magic can also appear inside captured output or event bytes, take the first match with a consistent header
+    start = data.find(b"SRTR")
+    unsupported = None
+    while start >= 0:
+        if start + HEADER_SIZE <= len(data):
+            version, event_size, count, overwritten = struct.unpack_from("<BBHI", data, start + 4)
+            if version != 1:
+                unsupported = version
+            elif event_size >= EVENT_SIZE and count * event_size <= len(data) - start - HEADER_SIZE:
+                return start, event_size, count, overwritten
+        start = data.find(b"SRTR", start + 1)
+    if unsupported is not None:
+        raise ValueError("unsupported trace version %d" % unsupported)
+    raise ValueError("no complete trace dump found in input")
+
+
+def read_events(data):
+    start, event_size, count, overwritten = find_dump(data)
+    offset = start + HEADER_SIZE
+    events = []
+    for i in range(count):
+        timestamp, phase_core, component, stage, idx = struct.unpack_from("<IBBBB", data, offset + i * event_size)
+        events.append((timestamp, phase_core >> 7, phase_core & 0x7F, component, stage, idx))
+    return events, overwritten
+
+
+def unwrap(events):
+    # micros() wraps every ~71 minutes, keep timestamps monotonic
+    result = []
+    base = 0
+    previous = None
+    for event in events:
+        timestamp = event[0]
+        if previous is not None and timestamp + base < previous and previous - (timestamp + base) > 0x80000000:
+            base += 0x100000000
+        previous = timestamp + base
+        result.append((previous,) + event[1:])
+    return result
+
+
+def to_chrome(events):
+    # Pair begin/end per (core, component, stage, id) into complete events, async tasks do not nest with the loop
+    open_events = {}
+    trace = []
+    threads = {}
+    for timestamp, phase, core, component, stage, idx in events:
+        key = (core, component, stage, idx)
+        if phase == 0:
+            open_events.setdefault(key, []).append(timestamp)
+        elif open_events.get(key):
+            begin = open_events[key].pop()
+            component_name = COMPONENTS[component] if component < len(COMPONENTS) else str(component)
+            stage_name = STAGES[stage] if stage < len(STAGES) else str(stage)
+            tid = (core << 16) | (component << 8) | idx
+            threads[tid] = "core %d / %s %d" % (core, component_name, idx)
+            trace.append({
+                "name": "%s %d %s" % (component_name, idx, stage_name),
+                "cat": component_name,
+                "ph": "X",
+                "ts": begin,
+                "dur": timestamp - begin,
+                "pid": 0,
+                "tid": tid,
+                "args": {"core": core, "id": idx, "stage": stage_name},
+            })
+    trace.append({"name": "process_name", "ph": "M", "pid": 0, "args": {"name": "esp32"}})
+    for tid, name in sorted(threads.items()):
+        trace.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": tid, "args": {"name": name}})
+    return {"traceEvents": trace, "displayTimeUnit": "ms"}
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip())
+        return 1
+    with open(sys.argv[1], "rb") as f:
+        events, overwritten = read_events(f.read())
+    result = to_chrome(unwrap(events))
+    if overwritten:
+        sys.stderr.write("note: %d older events were overwritten in the ring buffer\n" % overwritten)
+    output = sys.argv[2] if len(sys.argv) > 2 else sys.argv[1] + ".json"
+    with open(output, "w") as f:
+        json.dump(result, f)
+    sys.stderr.write("wrote %d events to %s\n" % (len(result["traceEvents"]), output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())